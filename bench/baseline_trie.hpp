@@ -0,0 +1,157 @@
+/**
+ * @file baseline_trie.hpp
+ * @brief The original node layout (one std::unordered_map per node), kept as a benchmark reference.
+ *
+ * Notes:
+ * - Same insert/contains/suggest/search_ranked behaviour the library started
+ *   from: heap-allocated nodes, unsorted children, plain DP edit distance.
+ * - Not part of the library. Only trie_bench includes it.
+ */
+
+#ifndef TRIE_BENCH_BASELINE_TRIE_HPP
+#define TRIE_BENCH_BASELINE_TRIE_HPP
+
+#include <trie/detail/scoring.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace trie_bench
+{
+  class BaselineTrie final
+  {
+  public:
+    void insert(std::string_view word, std::uint64_t weight = 1)
+    {
+      Node *node = &root_;
+      for (char c : word)
+      {
+        auto &next = node->children[c];
+        if (!next)
+        {
+          next = std::make_unique<Node>();
+        }
+        node = next.get();
+      }
+      node->is_terminal = true;
+      node->frequency += weight;
+    }
+
+    bool contains(std::string_view word) const
+    {
+      const Node *node = find(word);
+      return node && node->is_terminal;
+    }
+
+    std::vector<std::string> suggest(std::string_view prefix, std::size_t limit = 0) const
+    {
+      std::vector<std::string> out;
+      if (const Node *node = find(prefix))
+      {
+        std::string current(prefix);
+        collect_suggestions(node, current, out, limit);
+      }
+      return out;
+    }
+
+    std::vector<std::string> search_ranked(std::string_view query, std::size_t limit = 10) const
+    {
+      std::vector<Scored> scored;
+      std::string current;
+      std::vector<int> rows;
+      collect_scored(&root_, current, scored, query, rows);
+
+      std::sort(scored.begin(), scored.end(), [](const Scored &a, const Scored &b)
+                {
+        if (a.score != b.score) return a.score > b.score;
+        return a.word < b.word; });
+
+      const std::size_t take = (limit == 0) ? scored.size() : std::min(limit, scored.size());
+      std::vector<std::string> out;
+      out.reserve(take);
+      for (std::size_t i = 0; i < take; ++i)
+      {
+        out.push_back(std::move(scored[i].word));
+      }
+      return out;
+    }
+
+  private:
+    struct Node final
+    {
+      std::unordered_map<char, std::unique_ptr<Node>> children{};
+      bool is_terminal{false};
+      std::uint64_t frequency{0};
+    };
+
+    struct Scored final
+    {
+      std::string word;
+      double score;
+    };
+
+    const Node *find(std::string_view key) const
+    {
+      const Node *node = &root_;
+      for (char c : key)
+      {
+        const auto it = node->children.find(c);
+        if (it == node->children.end())
+        {
+          return nullptr;
+        }
+        node = it->second.get();
+      }
+      return node;
+    }
+
+    static void collect_suggestions(const Node *node, std::string &current, std::vector<std::string> &out, std::size_t limit)
+    {
+      if (node->is_terminal)
+      {
+        out.push_back(current);
+        if (limit != 0 && out.size() >= limit)
+        {
+          return;
+        }
+      }
+      for (const auto &kv : node->children)
+      {
+        current.push_back(kv.first);
+        collect_suggestions(kv.second.get(), current, out, limit);
+        current.pop_back();
+        if (limit != 0 && out.size() >= limit)
+        {
+          return;
+        }
+      }
+    }
+
+    static void collect_scored(const Node *node, std::string &current, std::vector<Scored> &out,
+                               std::string_view query, std::vector<int> &rows)
+    {
+      if (node->is_terminal)
+      {
+        const int d = trie::detail::levenshtein_distance(query, current, rows);
+        out.push_back(Scored{current, trie::detail::score_distance(d, current.size(), node->frequency)});
+      }
+      for (const auto &kv : node->children)
+      {
+        current.push_back(kv.first);
+        collect_scored(kv.second.get(), current, out, query, rows);
+        current.pop_back();
+      }
+    }
+
+    Node root_;
+  };
+
+} // namespace trie_bench
+
+#endif // TRIE_BENCH_BASELINE_TRIE_HPP
@@ -0,0 +1,182 @@
+/**
+ * @file datasets.hpp
+ * @brief Reproducible benchmark corpora.
+ *
+ * Notes:
+ * - Every corpus is generated from a fixed seed, so runs on different
+ *   machines and commits use the same keys.
+ * - english: pronounceable words built from syllables, 1 to 4 syllables long.
+ *   urls: scheme, host, path segments and an optional query string.
+ *   random_bytes: 4 to 24 uniformly random bytes, including 0x00 and 0xff.
+ * - Frequencies follow a Zipf law (s = 1.07), assigned in random order.
+ */
+
+#ifndef TRIE_BENCH_DATASETS_HPP
+#define TRIE_BENCH_DATASETS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace trie_bench
+{
+  enum class Dataset
+  {
+    english,
+    urls,
+    random_bytes,
+  };
+
+  inline constexpr std::string_view dataset_name(Dataset d) noexcept
+  {
+    switch (d)
+    {
+    case Dataset::english:
+      return "english";
+    case Dataset::urls:
+      return "urls";
+    case Dataset::random_bytes:
+      return "random_bytes";
+    }
+    return "unknown";
+  }
+
+  /**
+   * @brief Unique keys with frequencies, plus the probes the query benchmarks replay.
+   */
+  struct Corpus final
+  {
+    std::vector<std::string> words;
+    std::vector<std::uint64_t> frequencies;
+    /// Half present words, half absent ones.
+    std::vector<std::string> lookups;
+    /// Prefixes of present words.
+    std::vector<std::string> prefixes;
+    /// Present words with one byte substituted.
+    std::vector<std::string> typos;
+
+    /// (word, frequency) pairs in ascending byte order, for the sorted builders.
+    std::vector<std::pair<std::string_view, std::uint64_t>> sorted_counts() const
+    {
+      std::vector<std::pair<std::string_view, std::uint64_t>> out;
+      out.reserve(words.size());
+      for (std::size_t i = 0; i < words.size(); ++i)
+      {
+        out.emplace_back(words[i], frequencies[i]);
+      }
+      std::sort(out.begin(), out.end());
+      return out;
+    }
+  };
+
+  namespace detail
+  {
+    inline std::string english_word(std::mt19937_64 &rng)
+    {
+      static constexpr std::string_view onsets[] = {
+          "", "b", "c", "d", "f", "g", "h", "l", "m", "n", "p", "r", "s", "t", "v", "w",
+          "br", "ch", "cl", "dr", "gr", "pl", "sh", "st", "th", "tr"};
+      static constexpr std::string_view nuclei[] = {"a", "e", "i", "o", "u", "ai", "ea", "ee", "ou", "y"};
+      static constexpr std::string_view codas[] = {"", "", "n", "r", "s", "t", "l", "ng", "st", "ck", "ed", "ing"};
+
+      std::string w;
+      const std::size_t syllables = 1 + rng() % 4;
+      for (std::size_t i = 0; i < syllables; ++i)
+      {
+        w += onsets[rng() % std::size(onsets)];
+        w += nuclei[rng() % std::size(nuclei)];
+        w += codas[rng() % std::size(codas)];
+      }
+      return w;
+    }
+
+    inline std::string url(std::mt19937_64 &rng)
+    {
+      static constexpr std::string_view hosts[] = {
+          "example.com", "www.example.org", "shop.example.net", "docs.example.io",
+          "cdn.example.com", "api.example.dev", "blog.example.co.uk", "m.example.com"};
+
+      std::string u = (rng() % 4 == 0) ? "http://" : "https://";
+      u += hosts[rng() % std::size(hosts)];
+      const std::size_t segments = 1 + rng() % 4;
+      for (std::size_t i = 0; i < segments; ++i)
+      {
+        u += '/';
+        u += english_word(rng);
+      }
+      if (rng() % 3 == 0)
+      {
+        u += "?id=" + std::to_string(rng() % 100000);
+      }
+      return u;
+    }
+
+    inline std::string random_bytes(std::mt19937_64 &rng)
+    {
+      std::string w(4 + rng() % 21, '\0');
+      for (char &c : w)
+      {
+        c = static_cast<char>(rng() & 0xff);
+      }
+      return w;
+    }
+  } // namespace detail
+
+  /**
+   * @brief Build @p n unique keys of @p dataset and their probes. Same arguments, same corpus.
+   */
+  inline Corpus make_corpus(Dataset dataset, std::size_t n, std::uint64_t seed = 42)
+  {
+    std::mt19937_64 rng(seed ^ (static_cast<std::uint64_t>(dataset) << 32));
+    Corpus c;
+
+    std::unordered_set<std::string> seen;
+    seen.reserve(n * 2);
+    while (c.words.size() < n)
+    {
+      std::string w = dataset == Dataset::english ? detail::english_word(rng)
+                      : dataset == Dataset::urls  ? detail::url(rng)
+                                                  : detail::random_bytes(rng);
+      if (seen.insert(w).second)
+      {
+        c.words.push_back(std::move(w));
+      }
+    }
+
+    c.frequencies.resize(n);
+    for (std::size_t r = 0; r < n; ++r)
+    {
+      c.frequencies[r] = static_cast<std::uint64_t>(1e6 / std::pow(static_cast<double>(r + 1), 1.07)) + 1;
+    }
+    std::shuffle(c.frequencies.begin(), c.frequencies.end(), rng);
+
+    constexpr std::size_t probes = 4096;
+    for (std::size_t i = 0; i < probes; ++i)
+    {
+      const std::string &w = c.words[rng() % n];
+
+      c.lookups.push_back(w);
+      if (i % 2 == 1)
+      {
+        c.lookups.back().push_back('\x7f');
+      }
+
+      c.prefixes.push_back(w.substr(0, std::max<std::size_t>(1, w.size() / 2)));
+
+      std::string typo = w;
+      typo[rng() % typo.size()] = static_cast<char>('a' + rng() % 26);
+      c.typos.push_back(std::move(typo));
+    }
+    return c;
+  }
+
+} // namespace trie_bench
+
+#endif // TRIE_BENCH_DATASETS_HPP
@@ -0,0 +1,374 @@
+/**
+ * @file trie_bench.cpp
+ * @brief Google Benchmark suite for build, lookup, suggest and ranked search.
+ *
+ * Notes:
+ * - Each benchmark is registered for every engine, dataset and dictionary
+ *   size. Filter with --benchmark_filter, e.g. "BM_Contains<(Baseline|TrieNone)>".
+ * - Build reports keys/s, live heap bytes per key and teardown time.
+ * - Query benchmarks report queries/s and latency percentiles (p50, p99,
+ *   p999, in ns). Percentiles include one steady_clock read per query.
+ * - Corpora and built engines are cached per (dataset, size), so repeated
+ *   runs of a benchmark measure queries only.
+ */
+
+#include "baseline_trie.hpp"
+#include "datasets.hpp"
+
+#include <trie/dawg.hpp>
+#include <trie/flat_trie.hpp>
+#include <trie/radix_trie.hpp>
+#include <trie/sharded_trie.hpp>
+#include <trie/trie.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace
+{
+  using trie_bench::Corpus;
+  using trie_bench::Dataset;
+  using Clock = std::chrono::steady_clock;
+
+  /// Bytes currently allocated from the heap, or 0 where the allocator cannot tell.
+  std::int64_t heap_in_use()
+  {
+#if defined(__GLIBC__)
+    const struct mallinfo2 mi = mallinfo2();
+    return static_cast<std::int64_t>(mi.uordblks + mi.hblkhd);
+#else
+    return 0;
+#endif
+  }
+
+  const Corpus &corpus(Dataset dataset, std::size_t n)
+  {
+    static std::map<std::pair<Dataset, std::size_t>, Corpus> cache;
+    auto it = cache.find({dataset, n});
+    if (it == cache.end())
+    {
+      it = cache.emplace(std::make_pair(dataset, n), trie_bench::make_corpus(dataset, n)).first;
+    }
+    return it->second;
+  }
+
+  // Engines: build(corpus) plus contains / suggest / search_ranked.
+
+  template <trie::Concurrency Mode>
+  struct TrieEngine final
+  {
+    trie::Trie t{Mode};
+
+    static std::unique_ptr<TrieEngine> build(const Corpus &c)
+    {
+      auto e = std::make_unique<TrieEngine>();
+      for (std::size_t i = 0; i < c.words.size(); ++i)
+      {
+        e->t.insert(c.words[i], c.frequencies[i]);
+      }
+      return e;
+    }
+
+    bool contains(std::string_view w) const { return t.contains(w); }
+    std::vector<std::string> suggest(std::string_view p) const { return t.suggest(p, 10); }
+    std::vector<std::string> search_ranked(std::string_view q) const { return t.search_ranked(q, 10); }
+  };
+
+  using TrieNone = TrieEngine<trie::Concurrency::none>;
+  using TrieShared = TrieEngine<trie::Concurrency::shared>;
+  using TrieSnapshot = TrieEngine<trie::Concurrency::snapshot>;
+
+  struct TrieSorted final
+  {
+    trie::Trie t;
+
+    static std::unique_ptr<TrieSorted> build(const Corpus &c)
+    {
+      auto e = std::make_unique<TrieSorted>();
+      e->t.build_from_sorted(c.sorted_counts());
+      return e;
+    }
+
+    bool contains(std::string_view w) const { return t.contains(w); }
+    std::vector<std::string> suggest(std::string_view p) const { return t.suggest(p, 10); }
+    std::vector<std::string> search_ranked(std::string_view q) const { return t.search_ranked(q, 10); }
+  };
+
+  struct TrieFrozen final
+  {
+    trie::Trie t;
+
+    static std::unique_ptr<TrieFrozen> build(const Corpus &c)
+    {
+      auto e = std::make_unique<TrieFrozen>();
+      for (std::size_t i = 0; i < c.words.size(); ++i)
+      {
+        e->t.insert(c.words[i], c.frequencies[i]);
+      }
+      e->t.freeze();
+      return e;
+    }
+
+    bool contains(std::string_view w) const { return t.contains(w); }
+    std::vector<std::string> suggest(std::string_view p) const { return t.suggest(p, 10); }
+    std::vector<std::string> search_ranked(std::string_view q) const { return t.search_ranked(q, 10); }
+  };
+
+  struct Radix final
+  {
+    trie::RadixTrie t;
+
+    static std::unique_ptr<Radix> build(const Corpus &c)
+    {
+      auto e = std::make_unique<Radix>();
+      for (const std::string &w : c.words)
+      {
+        e->t.insert(w);
+      }
+      return e;
+    }
+
+    bool contains(std::string_view w) const { return t.contains(w); }
+    std::vector<std::string> suggest(std::string_view p) const { return t.suggest(p, 10); }
+    std::vector<std::string> search_ranked(std::string_view q) const { return t.search_ranked(q, 10); }
+  };
+
+  struct Flat final
+  {
+    std::vector<std::byte> image;
+    trie::FlatTrieView view;
+
+    static std::unique_ptr<Flat> build(const Corpus &c)
+    {
+      auto e = std::make_unique<Flat>();
+      e->image = trie::flat::build_from_sorted(c.sorted_counts());
+      e->view = trie::FlatTrieView(e->image);
+      return e;
+    }
+
+    bool contains(std::string_view w) const { return view.contains(w); }
+    std::vector<std::string> suggest(std::string_view p) const { return view.suggest(p, 10); }
+    std::vector<std::string> search_ranked(std::string_view q) const { return view.search_ranked(q, 10); }
+  };
+
+  struct Dawg final
+  {
+    trie::Dawg d;
+
+    static std::unique_ptr<Dawg> build(const Corpus &c)
+    {
+      auto e = std::make_unique<Dawg>();
+      e->d = trie::Dawg::build_from_sorted(c.sorted_counts());
+      return e;
+    }
+
+    bool contains(std::string_view w) const { return d.contains(w); }
+    std::vector<std::string> suggest(std::string_view p) const { return d.suggest(p, 10); }
+    std::vector<std::string> search_ranked(std::string_view q) const { return d.search_ranked(q, 10); }
+  };
+
+  struct Sharded final
+  {
+    trie::ShardedTrie t{4};
+
+    static std::unique_ptr<Sharded> build(const Corpus &c)
+    {
+      auto e = std::make_unique<Sharded>();
+      for (std::size_t i = 0; i < c.words.size(); ++i)
+      {
+        e->t.insert(c.words[i], c.frequencies[i]);
+      }
+      return e;
+    }
+
+    bool contains(std::string_view w) const { return t.contains(w); }
+    std::vector<std::string> suggest(std::string_view p) const { return t.suggest(p, 10); }
+    std::vector<std::string> search_ranked(std::string_view q) const { return t.search_ranked(q, 10); }
+  };
+
+  struct Baseline final
+  {
+    trie_bench::BaselineTrie t;
+
+    static std::unique_ptr<Baseline> build(const Corpus &c)
+    {
+      auto e = std::make_unique<Baseline>();
+      for (std::size_t i = 0; i < c.words.size(); ++i)
+      {
+        e->t.insert(c.words[i], c.frequencies[i]);
+      }
+      return e;
+    }
+
+    bool contains(std::string_view w) const { return t.contains(w); }
+    std::vector<std::string> suggest(std::string_view p) const { return t.suggest(p, 10); }
+    std::vector<std::string> search_ranked(std::string_view q) const { return t.search_ranked(q, 10); }
+  };
+
+  // Benchmarks. Arguments: (dataset, dictionary size).
+
+  const Corpus &corpus_of(benchmark::State &state)
+  {
+    const auto dataset = static_cast<Dataset>(state.range(0));
+    const auto n = static_cast<std::size_t>(state.range(1));
+    state.SetLabel(std::string(trie_bench::dataset_name(dataset)));
+    return corpus(dataset, n);
+  }
+
+  template <typename Engine>
+  const Engine &engine_of(benchmark::State &state)
+  {
+    static std::map<std::pair<std::int64_t, std::int64_t>, std::unique_ptr<Engine>> cache;
+    const Corpus &c = corpus_of(state);
+    auto &slot = cache[{state.range(0), state.range(1)}];
+    if (!slot)
+    {
+      slot = Engine::build(c);
+    }
+    return *slot;
+  }
+
+  template <typename Engine>
+  void BM_Build(benchmark::State &state)
+  {
+    const Corpus &c = corpus_of(state);
+    std::int64_t bytes = 0;
+    double teardown_ns = 0;
+
+    for (auto _ : state)
+    {
+      const std::int64_t before = heap_in_use();
+      std::unique_ptr<Engine> e = Engine::build(c);
+      benchmark::DoNotOptimize(e.get());
+
+      state.PauseTiming();
+      bytes = heap_in_use() - before;
+      const Clock::time_point t0 = Clock::now();
+      e.reset();
+      teardown_ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+      state.ResumeTiming();
+    }
+
+    const double keys = static_cast<double>(c.words.size());
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(c.words.size()));
+    state.counters["bytes_per_key"] = static_cast<double>(bytes) / keys;
+    state.counters["teardown_ms"] = teardown_ns / static_cast<double>(state.iterations()) / 1e6;
+  }
+
+  /**
+   * @brief Replay @p probes through @p op, one per iteration, and record latency percentiles.
+   */
+  template <typename Op>
+  void run_queries(benchmark::State &state, const std::vector<std::string> &probes, Op op)
+  {
+    constexpr std::size_t max_samples = std::size_t{1} << 20;
+    std::vector<std::int64_t> samples;
+    samples.reserve(std::min<std::size_t>(max_samples, 1u << 16));
+
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+      const Clock::time_point t0 = Clock::now();
+      op(probes[i]);
+      const Clock::time_point t1 = Clock::now();
+      if (samples.size() < max_samples)
+      {
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+      }
+      i = (i + 1 == probes.size()) ? 0 : i + 1;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (samples.empty())
+    {
+      return;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto at = [&samples](double q)
+    { return static_cast<double>(samples[static_cast<std::size_t>(q * static_cast<double>(samples.size() - 1))]); };
+    state.counters["p50_ns"] = at(0.50);
+    state.counters["p99_ns"] = at(0.99);
+    state.counters["p999_ns"] = at(0.999);
+  }
+
+  template <typename Engine>
+  void BM_Contains(benchmark::State &state)
+  {
+    const Engine &e = engine_of<Engine>(state);
+    run_queries(state, corpus_of(state).lookups, [&e](const std::string &w)
+                { benchmark::DoNotOptimize(e.contains(w)); });
+  }
+
+  template <typename Engine>
+  void BM_Suggest(benchmark::State &state)
+  {
+    const Engine &e = engine_of<Engine>(state);
+    run_queries(state, corpus_of(state).prefixes, [&e](const std::string &p)
+                { benchmark::DoNotOptimize(e.suggest(p)); });
+  }
+
+  template <typename Engine>
+  void BM_SearchRanked(benchmark::State &state)
+  {
+    const Engine &e = engine_of<Engine>(state);
+    run_queries(state, corpus_of(state).typos, [&e](const std::string &q)
+                { benchmark::DoNotOptimize(e.search_ranked(q)); });
+  }
+
+  void all_sizes(benchmark::internal::Benchmark *b)
+  {
+    for (int dataset = 0; dataset < 3; ++dataset)
+    {
+      for (std::int64_t n : {std::int64_t{1} << 12, std::int64_t{1} << 15, std::int64_t{1} << 18})
+      {
+        b->Args({dataset, n});
+      }
+    }
+  }
+
+  /// search_ranked scans every word, so the largest dictionaries are left out.
+  void scan_sizes(benchmark::internal::Benchmark *b)
+  {
+    for (int dataset = 0; dataset < 3; ++dataset)
+    {
+      for (std::int64_t n : {std::int64_t{1} << 12, std::int64_t{1} << 15})
+      {
+        b->Args({dataset, n});
+      }
+    }
+  }
+
+} // namespace
+
+#define TRIE_BENCH_ENGINE(Engine)                                                                             \
+  BENCHMARK_TEMPLATE(BM_Build, Engine)->Apply(all_sizes)->ArgNames({"dataset", "n"})->Unit(benchmark::kMillisecond); \
+  BENCHMARK_TEMPLATE(BM_Contains, Engine)->Apply(all_sizes)->ArgNames({"dataset", "n"});                           \
+  BENCHMARK_TEMPLATE(BM_Suggest, Engine)->Apply(all_sizes)->ArgNames({"dataset", "n"});                            \
+  BENCHMARK_TEMPLATE(BM_SearchRanked, Engine)->Apply(scan_sizes)->ArgNames({"dataset", "n"})->Unit(benchmark::kMicrosecond)
+
+TRIE_BENCH_ENGINE(Baseline);
+TRIE_BENCH_ENGINE(TrieNone);
+TRIE_BENCH_ENGINE(TrieShared);
+TRIE_BENCH_ENGINE(TrieSnapshot);
+TRIE_BENCH_ENGINE(TrieSorted);
+TRIE_BENCH_ENGINE(TrieFrozen);
+TRIE_BENCH_ENGINE(Radix);
+TRIE_BENCH_ENGINE(Flat);
+TRIE_BENCH_ENGINE(Dawg);
+TRIE_BENCH_ENGINE(Sharded);
+
+BENCHMARK_MAIN();
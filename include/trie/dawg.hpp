@@ -0,0 +1,616 @@
+/**
+ * @file dawg.hpp
+ * @brief Minimal acyclic automaton (DAWG) sharing both prefixes and suffixes.
+ *
+ * Notes:
+ * - Built from sorted input with the incremental algorithm of Daciuk et al.:
+ *   once a state can get no more edges it is merged with an equivalent state
+ *   if one exists. The result is the minimal automaton for the word set.
+ * - Frequencies cannot live on shared states. Each state counts the words
+ *   below it, which maps each word to its rank in sorted order; frequencies
+ *   are stored in one array indexed by that rank.
+ * - suggest(), search_ranked() and search_fuzzy() return the same results as
+ *   trie::Trie holding the same words and frequencies.
+ */
+
+#ifndef TRIE_DAWG_HPP
+#define TRIE_DAWG_HPP
+
+#include <trie/detail/scoring.hpp>
+#include <trie/detail/sorted_input.hpp>
+#include <trie/query_context.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace trie
+{
+  class DawgBuilder;
+
+  /**
+   * @brief Immutable word set stored as a minimal DAWG, with a frequency per word.
+   *
+   * Features:
+   * - build_from_sorted(words)
+   * - contains(word), frequency(word)
+   * - suggest(prefix, limit)
+   * - search_ranked(query, limit)
+   * - search_fuzzy(query, max_distance, limit)
+   *
+   * Thread safety:
+   * - Immutable after construction. Any number of threads may query one Dawg.
+   */
+  class Dawg final
+  {
+  public:
+    /**
+     * @brief Construct an empty automaton.
+     */
+    Dawg()
+        : states_(1)
+    {
+    }
+
+    /**
+     * @brief Build from a sorted range of words or (word, frequency) pairs.
+     *
+     * Throws std::invalid_argument if the input is out of order.
+     */
+    template <typename Range>
+    static Dawg build_from_sorted(const Range &words);
+
+    /**
+     * @brief Number of words.
+     */
+    std::size_t size() const noexcept { return frequencies_.size(); }
+
+    std::size_t state_count() const noexcept { return states_.size(); }
+    std::size_t edge_count() const noexcept { return targets_.size(); }
+
+    /**
+     * @brief Bytes held by the automaton's arrays.
+     */
+    std::size_t memory_bytes() const noexcept
+    {
+      return states_.size() * sizeof(State) +
+             labels_.size() * sizeof(unsigned char) +
+             targets_.size() * sizeof(std::uint32_t) +
+             frequencies_.size() * sizeof(std::uint64_t);
+    }
+
+    bool contains(std::string_view word) const noexcept
+    {
+      return rank_of(word) != npos;
+    }
+
+    /**
+     * @brief Frequency of @p word, or 0 if absent.
+     */
+    std::uint64_t frequency(std::string_view word) const noexcept
+    {
+      const std::uint32_t rank = rank_of(word);
+      return rank == npos ? 0 : frequencies_[rank];
+    }
+
+    std::vector<std::string> suggest(std::string_view prefix, std::size_t limit = 0) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      suggest(prefix, limit, ctx, [&out](std::string_view word)
+              { out.emplace_back(word); });
+      return out;
+    }
+
+    template <typename Visitor>
+    std::size_t suggest(std::string_view prefix, std::size_t limit, QueryContext &ctx, Visitor &&visit) const
+    {
+      std::uint32_t state = 0;
+      std::uint32_t rank = 0;
+      if (!locate(prefix, state, rank))
+      {
+        return 0;
+      }
+
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      sc.key.assign(prefix);
+      std::size_t count = 0;
+      collect_suggestions(state, sc, limit, count, visit);
+      return count;
+    }
+
+    std::vector<std::string> search_ranked(std::string_view query, std::size_t limit = 10) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      search_ranked(query, limit, ctx, [&out](std::string_view word)
+                    { out.emplace_back(word); });
+      return out;
+    }
+
+    template <typename Visitor>
+    std::size_t search_ranked(std::string_view query, std::size_t limit, QueryContext &ctx, Visitor &&visit) const
+    {
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      sc.reset(limit);
+      detail::prepare_distance(sc, query);
+      collect_scored(sc, query);
+      return detail::emit_ranked(sc, limit, visit);
+    }
+
+    std::vector<std::string> search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit = 10) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      search_fuzzy(query, max_distance, limit, ctx, [&out](std::string_view word)
+                   { out.emplace_back(word); });
+      return out;
+    }
+
+    template <typename Visitor>
+    std::size_t search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit,
+        QueryContext &ctx,
+        Visitor &&visit) const
+    {
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+
+      const std::size_t width = query.size() + 1;
+      sc.rows.resize(width);
+      for (std::size_t j = 0; j < width; ++j)
+      {
+        sc.rows[j] = static_cast<int>(j);
+      }
+      sc.reset(limit);
+
+      const State &root = states_[0];
+      if (root.terminal && query.size() <= max_distance)
+      {
+        detail::push_scored(sc, detail::score_distance(static_cast<int>(query.size()), 0, frequencies_[0]));
+      }
+
+      collect_fuzzy(sc, query, detail::distance_bound(max_distance));
+
+      return detail::emit_ranked(sc, limit, visit);
+    }
+
+  private:
+    friend class DawgBuilder;
+
+    static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+    /**
+     * @brief One state. Its edges are [first_edge, first_edge + edge_count), sorted by label.
+     */
+    struct State final
+    {
+      std::uint32_t first_edge{0};
+      std::uint16_t edge_count{0};
+      bool terminal{false};
+      /// Number of words accepted from this state.
+      std::uint32_t words{0};
+    };
+
+    /**
+     * @brief Follow the edge labelled @p c out of @p state.
+     *
+     * On success @p rank advances past the words that sort before the edge.
+     */
+    bool step(std::uint32_t &state, std::uint32_t &rank, char c) const noexcept
+    {
+      const State &s = states_[state];
+      const auto key = static_cast<unsigned char>(c);
+
+      std::uint32_t r = rank + s.terminal;
+      for (std::uint32_t e = s.first_edge; e < s.first_edge + s.edge_count; ++e)
+      {
+        if (labels_[e] == key)
+        {
+          state = targets_[e];
+          rank = r;
+          return true;
+        }
+        if (labels_[e] > key)
+        {
+          return false;
+        }
+        r += states_[targets_[e]].words;
+      }
+      return false;
+    }
+
+    bool locate(std::string_view prefix, std::uint32_t &state, std::uint32_t &rank) const noexcept
+    {
+      state = 0;
+      rank = 0;
+      for (char c : prefix)
+      {
+        if (!step(state, rank, c))
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    std::uint32_t rank_of(std::string_view word) const noexcept
+    {
+      std::uint32_t state = 0;
+      std::uint32_t rank = 0;
+      if (!locate(word, state, rank) || !states_[state].terminal)
+      {
+        return npos;
+      }
+      return rank;
+    }
+
+    /**
+     * @brief Visit the words below @p start in byte order; sc.key holds its key.
+     *
+     * Iterative preorder walk on sc.stack. sc.key is restored before returning.
+     */
+    template <typename Visitor>
+    bool collect_suggestions(
+        std::uint32_t start,
+        detail::QueryScratch &sc,
+        std::size_t limit,
+        std::size_t &count,
+        Visitor &visit) const
+    {
+      const std::size_t base = sc.key.size();
+      sc.stack.clear();
+
+      bool more = true;
+      std::uint32_t state = start;
+      std::uint32_t rank = 0;
+      do
+      {
+        const State &s = states_[state];
+        if (s.terminal)
+        {
+          ++count;
+          if (!detail::emit(visit, sc.key) || (limit != 0 && count >= limit))
+          {
+            more = false;
+            break;
+          }
+        }
+        push_edges(sc, s, rank);
+      } while (next_frame(sc, state, rank));
+
+      sc.key.resize(base);
+      return more;
+    }
+
+    /**
+     * @brief Score every word of the automaton; sc.key must be empty.
+     */
+    void collect_scored(detail::QueryScratch &sc, std::string_view query) const
+    {
+      sc.stack.clear();
+
+      std::uint32_t state = 0;
+      std::uint32_t rank = 0;
+      do
+      {
+        const State &s = states_[state];
+        if (s.terminal)
+        {
+          const int d = detail::levenshtein_distance(query, sc.key, sc);
+          detail::push_scored(sc, detail::score_distance(d, sc.key.size(), frequencies_[rank]));
+        }
+        push_edges(sc, s, rank);
+      } while (next_frame(sc, state, rank));
+
+      sc.key.clear();
+    }
+
+    /**
+     * @brief Bounded fuzzy walk below the root, one DP row per depth. sc.key must be empty.
+     */
+    void collect_fuzzy(detail::QueryScratch &sc, std::string_view query, int max_distance) const
+    {
+      const std::size_t width = query.size() + 1;
+
+      sc.stack.clear();
+      push_edges(sc, states_[0], 0);
+
+      std::uint32_t state = 0;
+      std::uint32_t rank = 0;
+      while (next_frame(sc, state, rank))
+      {
+        const std::size_t depth = sc.key.size();
+        sc.rows.resize((depth + 1) * width);
+        int *row = sc.rows.data() + depth * width;
+        const int row_min = detail::levenshtein_step(query, row - width, row, sc.key.back());
+
+        const State &s = states_[state];
+        if (s.terminal && row[width - 1] <= max_distance)
+        {
+          detail::push_scored(sc, detail::score_distance(row[width - 1], depth, frequencies_[rank]));
+        }
+        if (row_min <= max_distance)
+        {
+          push_edges(sc, s, rank);
+        }
+      }
+
+      sc.key.clear();
+    }
+
+    /**
+     * @brief Queue the edges of @p s, keyed after sc.key, to pop in byte order.
+     * @param rank Rank of the first word at or below @p s.
+     */
+    void push_edges(detail::QueryScratch &sc, const State &s, std::uint32_t rank) const
+    {
+      const std::size_t mark = sc.stack.size();
+      const auto key_size = static_cast<std::uint32_t>(sc.key.size());
+      rank += s.terminal;
+      for (std::uint32_t e = s.first_edge; e < s.first_edge + s.edge_count; ++e)
+      {
+        sc.stack.push_back(detail::Frame{e, key_size, rank});
+        rank += states_[targets_[e]].words;
+      }
+      std::reverse(sc.stack.begin() + static_cast<std::ptrdiff_t>(mark), sc.stack.end());
+    }
+
+    /**
+     * @brief Pop the next edge of the walk: set sc.key, @p state and @p rank. False when done.
+     */
+    bool next_frame(detail::QueryScratch &sc, std::uint32_t &state, std::uint32_t &rank) const
+    {
+      if (sc.stack.empty())
+      {
+        return false;
+      }
+      const detail::Frame f = sc.stack.back();
+      sc.stack.pop_back();
+      const auto e = static_cast<std::uint32_t>(f.node);
+      sc.key.resize(f.key_size);
+      sc.key.push_back(static_cast<char>(labels_[e]));
+      state = targets_[e];
+      rank = f.aux;
+      return true;
+    }
+
+    std::vector<State> states_;
+    std::vector<unsigned char> labels_{};
+    std::vector<std::uint32_t> targets_{};
+    std::vector<std::uint64_t> frequencies_{};
+  };
+
+  /**
+   * @brief Incremental builder for Dawg. Words must arrive in sorted order.
+   *
+   * Memory while building is proportional to the minimal automaton plus the
+   * longest word. Not copyable or movable: the state register refers back to
+   * the builder.
+   */
+  class DawgBuilder final
+  {
+  public:
+    DawgBuilder()
+        : register_(64, StateHash{this}, StateEqual{this})
+    {
+      states_.emplace_back();
+      path_.push_back(0);
+    }
+
+    DawgBuilder(const DawgBuilder &) = delete;
+    DawgBuilder &operator=(const DawgBuilder &) = delete;
+
+    /**
+     * @brief Add @p word. Throws std::invalid_argument if it sorts before the previous word.
+     *
+     * A repeated word adds @p frequency to the previous occurrence.
+     */
+    void add(std::string_view word, std::uint64_t frequency = 1)
+    {
+      const std::size_t common = detail::sorted_common_prefix(key_, word);
+
+      if (common == word.size() && common == key_.size() && states_[path_.back()].terminal)
+      {
+        frequencies_.back() = detail::saturating_add(frequencies_.back(), frequency);
+        return;
+      }
+
+      minimize(common);
+
+      for (std::size_t i = common; i < word.size(); ++i)
+      {
+        const std::uint32_t child = new_state();
+        states_[path_.back()].edges.emplace_back(static_cast<unsigned char>(word[i]), child);
+        path_.push_back(child);
+      }
+      key_.assign(word);
+
+      states_[path_.back()].terminal = true;
+      frequencies_.push_back(frequency);
+    }
+
+    /**
+     * @brief Minimize the remaining path and produce the automaton. The builder is empty afterwards.
+     */
+    Dawg finish()
+    {
+      minimize(0);
+      count_words(0);
+
+      // Renumber the live states breadth-first so that neighbours sit close together.
+      std::vector<std::uint32_t> remap(states_.size(), Dawg::npos);
+      std::vector<std::uint32_t> order{0};
+      remap[0] = 0;
+      for (std::size_t i = 0; i < order.size(); ++i)
+      {
+        for (const auto &edge : states_[order[i]].edges)
+        {
+          if (remap[edge.second] == Dawg::npos)
+          {
+            remap[edge.second] = static_cast<std::uint32_t>(order.size());
+            order.push_back(edge.second);
+          }
+        }
+      }
+
+      Dawg out;
+      out.states_.resize(order.size());
+      for (std::size_t i = 0; i < order.size(); ++i)
+      {
+        const BuildState &src = states_[order[i]];
+        Dawg::State &dst = out.states_[i];
+        dst.first_edge = static_cast<std::uint32_t>(out.targets_.size());
+        dst.edge_count = static_cast<std::uint16_t>(src.edges.size());
+        dst.terminal = src.terminal;
+        dst.words = src.words;
+        for (const auto &edge : src.edges)
+        {
+          out.labels_.push_back(edge.first);
+          out.targets_.push_back(remap[edge.second]);
+        }
+      }
+      out.frequencies_ = std::move(frequencies_);
+
+      register_.clear();
+      states_.clear();
+      free_.clear();
+      path_.clear();
+      frequencies_.clear();
+      key_.clear();
+      states_.emplace_back();
+      path_.push_back(0);
+      return out;
+    }
+
+  private:
+    struct BuildState final
+    {
+      std::vector<std::pair<unsigned char, std::uint32_t>> edges{};
+      bool terminal{false};
+      std::uint32_t words{0};
+    };
+
+    /// Hashes a state by its right language: finality and outgoing edges.
+    struct StateHash final
+    {
+      const DawgBuilder *b;
+
+      std::size_t operator()(std::uint32_t id) const noexcept
+      {
+        const BuildState &s = b->states_[id];
+        std::uint64_t h = s.terminal ? 0x9e3779b97f4a7c15ull : 0;
+        for (const auto &edge : s.edges)
+        {
+          const std::uint64_t v = (std::uint64_t{edge.first} << 32) | edge.second;
+          h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        }
+        return static_cast<std::size_t>(h);
+      }
+    };
+
+    struct StateEqual final
+    {
+      const DawgBuilder *b;
+
+      bool operator()(std::uint32_t x, std::uint32_t y) const noexcept
+      {
+        const BuildState &a = b->states_[x];
+        const BuildState &c = b->states_[y];
+        return a.terminal == c.terminal && a.edges == c.edges;
+      }
+    };
+
+    std::uint32_t new_state()
+    {
+      if (!free_.empty())
+      {
+        const std::uint32_t id = free_.back();
+        free_.pop_back();
+        return id;
+      }
+      if (states_.size() >= Dawg::npos)
+      {
+        throw std::length_error("trie: too many DAWG states");
+      }
+      states_.emplace_back();
+      return static_cast<std::uint32_t>(states_.size() - 1);
+    }
+
+    /**
+     * @brief Replace or register every state on the current path deeper than @p depth.
+     *
+     * Those states can get no more edges. Their children are already unique, so
+     * two of them are equivalent exactly when finality and edges are equal.
+     */
+    void minimize(std::size_t depth)
+    {
+      while (path_.size() > depth + 1)
+      {
+        const std::uint32_t child = path_.back();
+        path_.pop_back();
+        count_words(child);
+
+        const auto found = register_.find(child);
+        if (found != register_.end())
+        {
+          states_[path_.back()].edges.back().second = *found;
+          BuildState &dead = states_[child];
+          dead.edges.clear();
+          dead.terminal = false;
+          dead.words = 0;
+          free_.push_back(child);
+        }
+        else
+        {
+          register_.insert(child);
+        }
+      }
+    }
+
+    void count_words(std::uint32_t id)
+    {
+      BuildState &s = states_[id];
+      std::uint32_t words = s.terminal ? 1u : 0u;
+      for (const auto &edge : s.edges)
+      {
+        words += states_[edge.second].words;
+      }
+      s.words = words;
+    }
+
+    std::vector<BuildState> states_{};
+    std::vector<std::uint32_t> free_{};
+    std::unordered_set<std::uint32_t, StateHash, StateEqual> register_;
+    /// path_[d] is the state reached by the first d bytes of key_.
+    std::vector<std::uint32_t> path_{};
+    std::string key_{};
+    std::vector<std::uint64_t> frequencies_{};
+  };
+
+  template <typename Range>
+  Dawg Dawg::build_from_sorted(const Range &words)
+  {
+    DawgBuilder builder;
+    for (const auto &element : words)
+    {
+      const detail::SortedEntry e = detail::sorted_entry(element);
+      builder.add(e.word, e.frequency);
+    }
+    return builder.finish();
+  }
+
+} // namespace trie
+
+#endif // TRIE_DAWG_HPP
@@ -0,0 +1,282 @@
+/**
+ * @file arena.hpp
+ * @brief Chunked arena with size-class free lists for trie nodes and child blocks.
+ *
+ * Notes:
+ * - Memory comes from a std::pmr::memory_resource in large chunks.
+ * - Freed blocks go to an intrusive free list per 8-byte size class and are reused.
+ * - Destroying the arena releases whole chunks. Objects are not destructed, so
+ *   only trivially destructible types should rely on arena teardown.
+ * - Not thread-safe. Callers serialize mutation. Arenas built on several
+ *   threads can share one upstream through a LockedResource and later be
+ *   merged with adopt().
+ */
+
+#ifndef TRIE_DETAIL_ARENA_HPP
+#define TRIE_DETAIL_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace trie::detail
+{
+  /**
+   * @brief Bump allocator over pmr chunks with per-size free lists.
+   */
+  class Arena final
+  {
+  public:
+    static constexpr std::size_t alignment = alignof(std::max_align_t);
+    static constexpr std::size_t granule = 8;
+    static constexpr std::size_t first_chunk_size = 4096;
+    static constexpr std::size_t max_chunk_size = std::size_t{1} << 22;
+
+    explicit Arena(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : resource_(resource ? resource : std::pmr::get_default_resource())
+    {
+    }
+
+    ~Arena()
+    {
+      release();
+    }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    std::pmr::memory_resource *resource() const noexcept { return resource_; }
+
+    /**
+     * @brief Allocate @p bytes (rounded up to the granule).
+     */
+    void *allocate(std::size_t bytes)
+    {
+      const std::size_t size = round_up(bytes);
+      const std::size_t cls = size / granule;
+
+      if (cls < free_.size() && free_[cls] != nullptr)
+      {
+        FreeBlock *block = free_[cls];
+        free_[cls] = block->next;
+        return block;
+      }
+
+      if (size > static_cast<std::size_t>(end_ - cursor_))
+      {
+        add_chunk(size);
+      }
+
+      void *p = cursor_;
+      cursor_ += size;
+      return p;
+    }
+
+    /**
+     * @brief Return a block obtained from allocate() with the same @p bytes.
+     */
+    void deallocate(void *p, std::size_t bytes) noexcept
+    {
+      if (!p)
+      {
+        return;
+      }
+
+      const std::size_t cls = round_up(bytes) / granule;
+      if (cls >= free_.size())
+      {
+        // Growing the free list table can throw. Leaking into the arena is safe:
+        // the block is released with its chunk.
+        try
+        {
+          free_.resize(cls + 1, nullptr);
+        }
+        catch (...)
+        {
+          return;
+        }
+      }
+
+      auto *block = static_cast<FreeBlock *>(p);
+      block->next = free_[cls];
+      free_[cls] = block;
+    }
+
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+      static_assert(alignof(T) <= granule, "arena blocks are granule-aligned");
+      void *p = allocate(sizeof(T));
+      return ::new (p) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void destroy(T *p) noexcept
+    {
+      if (p)
+      {
+        p->~T();
+        deallocate(p, sizeof(T));
+      }
+    }
+
+    /**
+     * @brief Bytes obtained from the memory resource.
+     */
+    std::size_t reserved_bytes() const noexcept { return reserved_; }
+
+    /**
+     * @brief Exchange chunks and free lists with @p other. Blocks stay valid and
+     *        now belong to the other arena.
+     */
+    void swap(Arena &other) noexcept
+    {
+      std::swap(resource_, other.resource_);
+      chunks_.swap(other.chunks_);
+      free_.swap(other.free_);
+      std::swap(cursor_, other.cursor_);
+      std::swap(end_, other.end_);
+      std::swap(reserved_, other.reserved_);
+      std::swap(next_chunk_size_, other.next_chunk_size_);
+    }
+
+    /**
+     * @brief Take over the chunks and free blocks of @p other, leaving it empty.
+     *
+     * Blocks of @p other stay valid and now belong to this arena. Its chunks
+     * must be returnable to this arena's resource: the same resource, or a
+     * LockedResource over it.
+     */
+    void adopt(Arena &other)
+    {
+      chunks_.reserve(chunks_.size() + other.chunks_.size());
+      if (free_.size() < other.free_.size())
+      {
+        free_.resize(other.free_.size(), nullptr);
+      }
+
+      chunks_.insert(chunks_.end(), other.chunks_.begin(), other.chunks_.end());
+      for (std::size_t cls = 0; cls < other.free_.size(); ++cls)
+      {
+        FreeBlock *head = other.free_[cls];
+        if (!head)
+        {
+          continue;
+        }
+        FreeBlock *tail = head;
+        while (tail->next)
+        {
+          tail = tail->next;
+        }
+        tail->next = free_[cls];
+        free_[cls] = head;
+      }
+      reserved_ += other.reserved_;
+
+      other.chunks_.clear();
+      other.free_.clear();
+      other.cursor_ = nullptr;
+      other.end_ = nullptr;
+      other.reserved_ = 0;
+    }
+
+    /**
+     * @brief Release every chunk back to the memory resource.
+     */
+    void release() noexcept
+    {
+      for (const Chunk &c : chunks_)
+      {
+        resource_->deallocate(c.data, c.size, alignment);
+      }
+      chunks_.clear();
+      free_.clear();
+      cursor_ = nullptr;
+      end_ = nullptr;
+      reserved_ = 0;
+      next_chunk_size_ = first_chunk_size;
+    }
+
+  private:
+    struct FreeBlock final
+    {
+      FreeBlock *next;
+    };
+
+    struct Chunk final
+    {
+      void *data;
+      std::size_t size;
+    };
+
+    static constexpr std::size_t round_up(std::size_t bytes) noexcept
+    {
+      const std::size_t size = std::max(bytes, sizeof(FreeBlock));
+      return (size + granule - 1) & ~(granule - 1);
+    }
+
+    void add_chunk(std::size_t min_size)
+    {
+      const std::size_t size = std::max(next_chunk_size_, round_up(min_size));
+      chunks_.reserve(chunks_.size() + 1);
+
+      auto *data = static_cast<std::byte *>(resource_->allocate(size, alignment));
+      chunks_.push_back(Chunk{data, size});
+
+      cursor_ = data;
+      end_ = data + size;
+      reserved_ += size;
+      next_chunk_size_ = std::min(next_chunk_size_ * 2, max_chunk_size);
+    }
+
+    std::pmr::memory_resource *resource_;
+    std::vector<Chunk> chunks_{};
+    std::vector<FreeBlock *> free_{};
+    std::byte *cursor_{nullptr};
+    std::byte *end_{nullptr};
+    std::size_t reserved_{0};
+    std::size_t next_chunk_size_{first_chunk_size};
+  };
+
+  /**
+   * @brief Forwards to an upstream resource under a mutex, so arenas on
+   *        several threads can share an upstream that is not thread-safe.
+   */
+  class LockedResource final : public std::pmr::memory_resource
+  {
+  public:
+    explicit LockedResource(std::pmr::memory_resource *upstream) noexcept
+        : upstream_(upstream)
+    {
+    }
+
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      upstream_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+      return this == &other;
+    }
+
+    std::pmr::memory_resource *upstream_;
+    std::mutex mtx_;
+  };
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_ARENA_HPP
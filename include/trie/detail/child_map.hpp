@@ -0,0 +1,435 @@
+/**
+ * @file child_map.hpp
+ * @brief Adaptive byte-keyed child container used by trie nodes.
+ *
+ * Notes:
+ * - Up to inline_capacity children live inline in the node, sorted by byte.
+ * - Beyond that, children move to a heap block indexed by a 256-bit bitmap and
+ *   a rank-ordered pointer array. Lookup is one bit test plus a popcount.
+ *   A wide map moves back inline only at half the inline capacity, so
+ *   alternately adding and removing one child does not reallocate.
+ * - Iteration always yields children in ascending unsigned byte order.
+ * - Storage comes from a detail::Arena. The map owns neither its block nor its
+ *   children: both are released with the arena.
+ */
+
+#ifndef TRIE_DETAIL_CHILD_MAP_HPP
+#define TRIE_DETAIL_CHILD_MAP_HPP
+
+#include <trie/detail/arena.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace trie::detail
+{
+  /**
+   * @brief Sorted map from a byte to a child node.
+   *
+   * Trivially destructible so that nodes holding it can be dropped with their arena.
+   */
+  template <typename Node>
+  class ChildMap final
+  {
+  public:
+    static constexpr std::size_t inline_capacity = 4;
+
+    using value_type = std::pair<char, Node *>;
+
+    class const_iterator final
+    {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = ChildMap::value_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = value_type;
+
+      const_iterator() = default;
+
+      value_type operator*() const noexcept
+      {
+        return {static_cast<char>(key_), map_->node_at(rank_)};
+      }
+
+      const_iterator &operator++() noexcept
+      {
+        ++rank_;
+        if (rank_ < map_->size_)
+        {
+          key_ = map_->wide() ? map_->next_key(key_) : map_->small_.keys[rank_];
+        }
+        return *this;
+      }
+
+      const_iterator operator++(int) noexcept
+      {
+        const_iterator tmp = *this;
+        ++*this;
+        return tmp;
+      }
+
+      friend bool operator==(const const_iterator &a, const const_iterator &b) noexcept
+      {
+        return a.rank_ == b.rank_;
+      }
+
+    private:
+      friend class ChildMap;
+
+      const_iterator(const ChildMap *map, std::size_t rank) noexcept
+          : map_(map),
+            rank_(rank)
+      {
+        if (rank_ < map_->size_)
+        {
+          key_ = map_->wide() ? map_->next_key(-1) : map_->small_.keys[0];
+        }
+      }
+
+      const ChildMap *map_{nullptr};
+      std::size_t rank_{0};
+      int key_{0};
+    };
+
+    ChildMap() noexcept
+    {
+    }
+
+    ChildMap(const ChildMap &) = delete;
+    ChildMap &operator=(const ChildMap &) = delete;
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, size_); }
+
+    /**
+     * @brief Return the child for @p key, or nullptr.
+     */
+    Node *find(char key) const noexcept
+    {
+      const auto k = static_cast<unsigned char>(key);
+
+      if (!wide())
+      {
+        for (std::size_t i = 0; i < size_; ++i)
+        {
+          if (small_.keys[i] == k)
+          {
+            return small_.nodes[i];
+          }
+        }
+        return nullptr;
+      }
+
+      const std::uint64_t *bits = wide_;
+      const std::uint64_t bit = std::uint64_t{1} << (k & 63u);
+      if ((bits[k >> 6] & bit) == 0)
+      {
+        return nullptr;
+      }
+      return wide_nodes()[rank_of(k)];
+    }
+
+    /**
+     * @brief Insert a new child. @p key must not be present.
+     * @param arena Arena that backs this map's storage.
+     */
+    void emplace(char key, Node *child, Arena &arena)
+    {
+      const auto k = static_cast<unsigned char>(key);
+
+      if (!wide() && size_ < inline_capacity)
+      {
+        std::size_t pos = size_;
+        while (pos > 0 && small_.keys[pos - 1] > k)
+        {
+          small_.keys[pos] = small_.keys[pos - 1];
+          small_.nodes[pos] = small_.nodes[pos - 1];
+          --pos;
+        }
+        small_.keys[pos] = k;
+        small_.nodes[pos] = child;
+        ++size_;
+        return;
+      }
+
+      if (!wide() || size_ == capacity_)
+      {
+        grow(arena);
+      }
+
+      const std::size_t pos = rank_of(k);
+      Node **nodes = wide_nodes();
+      std::memmove(nodes + pos + 1, nodes + pos, (size_ - pos) * sizeof(Node *));
+      nodes[pos] = child;
+      wide_[k >> 6] |= std::uint64_t{1} << (k & 63u);
+      ++size_;
+    }
+
+    /**
+     * @brief Remove the entry for @p key, if present.
+     *
+     * A wide map that shrinks to inline_capacity / 2 moves back inline and
+     * returns its block to @p arena. Above that it keeps the block, so a
+     * child removed and added again costs no reallocation.
+     */
+    void erase(char key, Arena &arena)
+    {
+      const auto k = static_cast<unsigned char>(key);
+
+      if (!wide())
+      {
+        for (std::size_t i = 0; i < size_; ++i)
+        {
+          if (small_.keys[i] == k)
+          {
+            for (std::size_t j = i + 1; j < size_; ++j)
+            {
+              small_.keys[j - 1] = small_.keys[j];
+              small_.nodes[j - 1] = small_.nodes[j];
+            }
+            --size_;
+            return;
+          }
+        }
+        return;
+      }
+
+      const std::uint64_t bit = std::uint64_t{1} << (k & 63u);
+      if ((wide_[k >> 6] & bit) == 0)
+      {
+        return;
+      }
+
+      const std::size_t pos = rank_of(k);
+      Node **nodes = wide_nodes();
+      std::memmove(nodes + pos, nodes + pos + 1, (size_ - pos - 1) * sizeof(Node *));
+      wide_[k >> 6] &= ~bit;
+      --size_;
+
+      if (size_ <= inline_capacity / 2)
+      {
+        shrink_inline(arena);
+      }
+    }
+
+    /**
+     * @brief Fill this (empty) map from @p count children sorted by unsigned byte.
+     *
+     * Allocates an exactly sized block when the children do not fit inline.
+     */
+    void assign_sorted(const value_type *children, std::size_t count, Arena &arena)
+    {
+      if (count <= inline_capacity)
+      {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          small_.keys[i] = static_cast<unsigned char>(children[i].first);
+          small_.nodes[i] = children[i].second;
+        }
+        size_ = static_cast<std::uint16_t>(count);
+        return;
+      }
+
+      wide_ = static_cast<std::uint64_t *>(arena.allocate(block_bytes(count)));
+      std::memset(wide_, 0, bitmap_words * sizeof(std::uint64_t));
+      Node **nodes = wide_nodes();
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        const auto k = static_cast<unsigned char>(children[i].first);
+        wide_[k >> 6] |= std::uint64_t{1} << (k & 63u);
+        nodes[i] = children[i].second;
+      }
+      size_ = static_cast<std::uint16_t>(count);
+      capacity_ = static_cast<std::uint16_t>(count);
+    }
+
+    /**
+     * @brief Point the existing entry for @p key at @p child.
+     */
+    void replace(char key, Node *child) noexcept
+    {
+      const auto k = static_cast<unsigned char>(key);
+
+      if (!wide())
+      {
+        for (std::size_t i = 0; i < size_; ++i)
+        {
+          if (small_.keys[i] == k)
+          {
+            small_.nodes[i] = child;
+            return;
+          }
+        }
+        return;
+      }
+      wide_nodes()[rank_of(k)] = child;
+    }
+
+    /**
+     * @brief Make this (empty) map a copy of @p other, with its own storage.
+     */
+    void copy_from(const ChildMap &other, Arena &arena)
+    {
+      if (!other.wide())
+      {
+        small_ = other.small_;
+      }
+      else
+      {
+        wide_ = static_cast<std::uint64_t *>(arena.allocate(block_bytes(other.capacity_)));
+        std::memcpy(wide_, other.wide_, block_bytes(other.size_));
+      }
+      size_ = other.size_;
+      capacity_ = other.capacity_;
+    }
+
+    /**
+     * @brief Heap block owned by this map, or nullptr while children are inline.
+     */
+    void *storage() const noexcept { return wide() ? wide_ : nullptr; }
+
+    /**
+     * @brief Size of the block returned by storage().
+     */
+    std::size_t storage_bytes() const noexcept { return wide() ? block_bytes(capacity_) : 0; }
+
+    /**
+     * @brief Bytes of storage() a compact copy would not need: the capacity left
+     *        by doubling growth, or the whole block if the children fit inline.
+     */
+    std::size_t slack_bytes() const noexcept
+    {
+      if (!wide())
+      {
+        return 0;
+      }
+      return size_ <= inline_capacity ? block_bytes(capacity_) : block_bytes(capacity_) - block_bytes(size_);
+    }
+
+  private:
+    static constexpr std::size_t bitmap_words = 4;
+
+    bool wide() const noexcept { return capacity_ != 0; }
+
+    Node **wide_nodes() const noexcept
+    {
+      return reinterpret_cast<Node **>(wide_ + bitmap_words);
+    }
+
+    Node *node_at(std::size_t rank) const noexcept
+    {
+      return wide() ? wide_nodes()[rank] : small_.nodes[rank];
+    }
+
+    /**
+     * @brief Number of present keys strictly below @p k.
+     */
+    std::size_t rank_of(unsigned char k) const noexcept
+    {
+      const std::size_t word = k >> 6;
+      std::size_t rank = 0;
+      for (std::size_t w = 0; w < word; ++w)
+      {
+        rank += static_cast<std::size_t>(std::popcount(wide_[w]));
+      }
+      const std::uint64_t below = (std::uint64_t{1} << (k & 63u)) - 1;
+      return rank + static_cast<std::size_t>(std::popcount(wide_[word] & below));
+    }
+
+    /**
+     * @brief Smallest present key strictly greater than @p k (k may be -1).
+     */
+    int next_key(int k) const noexcept
+    {
+      int from = k + 1;
+      while (from < 256)
+      {
+        const std::uint64_t word = wide_[from >> 6] >> (from & 63);
+        if (word != 0)
+        {
+          return from + std::countr_zero(word);
+        }
+        from = (from | 63) + 1;
+      }
+      return 256;
+    }
+
+    static constexpr std::size_t block_bytes(std::size_t capacity) noexcept
+    {
+      return bitmap_words * sizeof(std::uint64_t) + capacity * sizeof(Node *);
+    }
+
+    void grow(Arena &arena)
+    {
+      const std::size_t new_capacity = wide() ? capacity_ * 2u : inline_capacity * 2u;
+
+      auto *block = static_cast<std::uint64_t *>(arena.allocate(block_bytes(new_capacity)));
+      auto *nodes = reinterpret_cast<Node **>(block + bitmap_words);
+
+      if (wide())
+      {
+        std::memcpy(block, wide_, bitmap_words * sizeof(std::uint64_t));
+        std::memcpy(nodes, wide_nodes(), size_ * sizeof(Node *));
+        arena.deallocate(wide_, block_bytes(capacity_));
+      }
+      else
+      {
+        std::memset(block, 0, bitmap_words * sizeof(std::uint64_t));
+        for (std::size_t i = 0; i < size_; ++i)
+        {
+          const unsigned char k = small_.keys[i];
+          block[k >> 6] |= std::uint64_t{1} << (k & 63u);
+          nodes[i] = small_.nodes[i];
+        }
+      }
+
+      wide_ = block;
+      capacity_ = static_cast<std::uint16_t>(new_capacity);
+    }
+
+    void shrink_inline(Arena &arena) noexcept
+    {
+      std::uint64_t *block = wide_;
+      const std::size_t bytes = block_bytes(capacity_);
+
+      Small small{};
+      int key = -1;
+      for (std::size_t i = 0; i < size_; ++i)
+      {
+        key = next_key(key);
+        small.keys[i] = static_cast<unsigned char>(key);
+        small.nodes[i] = wide_nodes()[i];
+      }
+
+      small_ = small;
+      capacity_ = 0;
+      arena.deallocate(block, bytes);
+    }
+
+    struct Small final
+    {
+      Node *nodes[inline_capacity];
+      unsigned char keys[inline_capacity];
+    };
+
+    union
+    {
+      Small small_;
+      std::uint64_t *wide_;
+    };
+
+    std::uint16_t size_{0};
+    std::uint16_t capacity_{0};
+  };
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_CHILD_MAP_HPP
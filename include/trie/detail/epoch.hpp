@@ -0,0 +1,186 @@
+/**
+ * @file epoch.hpp
+ * @brief Epoch-based reclamation for lock-free snapshot readers.
+ *
+ * Notes:
+ * - Readers pin the current epoch by bumping a counter in a padded per-thread
+ *   slot, indexed by the epoch's parity. Pinning never blocks.
+ * - The single writer advances the epoch once no reader is pinned in the
+ *   previous one. A block retired in epoch e is unreachable from any pinned
+ *   reader once the epoch reaches e + 2.
+ * - Reclamation is deferred: the writer frees what is safe at its next write.
+ */
+
+#ifndef TRIE_DETAIL_EPOCH_HPP
+#define TRIE_DETAIL_EPOCH_HPP
+
+#include <trie/detail/arena.hpp>
+#include <trie/detail/thread_slot.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trie::detail
+{
+  /**
+   * @brief Reader pinning and deferred arena reclamation for one structure.
+   *
+   * Pin objects may be created from any thread. retire() and collect() must be
+   * called by a single writer at a time.
+   */
+  class EpochDomain final
+  {
+    struct Slot;
+
+  public:
+    static constexpr std::size_t slot_count = 32;
+
+    /**
+     * @brief RAII pin of the current epoch.
+     */
+    class Pin final
+    {
+    public:
+      explicit Pin(const EpochDomain &domain) noexcept
+          : domain_(domain),
+            slot_(domain.slots_[thread_slot() % slot_count])
+      {
+        for (;;)
+        {
+          epoch_ = domain_.epoch_.load();
+          slot_.active[epoch_ & 1u].fetch_add(1);
+          if (domain_.epoch_.load() == epoch_)
+          {
+            return;
+          }
+          slot_.active[epoch_ & 1u].fetch_sub(1);
+        }
+      }
+
+      ~Pin()
+      {
+        slot_.active[epoch_ & 1u].fetch_sub(1);
+      }
+
+      Pin(const Pin &) = delete;
+      Pin &operator=(const Pin &) = delete;
+
+    private:
+      const EpochDomain &domain_;
+      Slot &slot_;
+      std::uint64_t epoch_{0};
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain &) = delete;
+
+    /**
+     * @brief Release the objects still waiting. Arena blocks go with their arena.
+     */
+    ~EpochDomain()
+    {
+      for (const Retired &r : retired_)
+      {
+        if (r.release)
+        {
+          r.release(r.p);
+        }
+      }
+    }
+
+    EpochDomain &operator=(const EpochDomain &) = delete;
+
+    /**
+     * @brief Defer freeing the @p bytes block at @p p until no reader can see it.
+     *
+     * Call after the structure stopped referencing @p p.
+     */
+    void retire(void *p, std::size_t bytes)
+    {
+      retired_.push_back(Retired{p, bytes, epoch_.load(), nullptr});
+    }
+
+    /**
+     * @brief Defer `release(p)` for an object outside the arena until no reader can see it.
+     */
+    void retire(void *p, void (*release)(void *))
+    {
+      retired_.push_back(Retired{p, 0, epoch_.load(), release});
+    }
+
+    /**
+     * @brief Advance the epoch as far as readers allow and free safe blocks and objects.
+     */
+    void collect(Arena &arena) noexcept
+    {
+      for (int step = 0; step < 2 && try_advance(); ++step)
+      {
+      }
+
+      const std::uint64_t now = epoch_.load();
+      std::size_t kept = 0;
+      for (const Retired &r : retired_)
+      {
+        if (r.epoch + 2 > now)
+        {
+          retired_[kept++] = r;
+        }
+        else if (r.release)
+        {
+          r.release(r.p);
+        }
+        else
+        {
+          arena.deallocate(r.p, r.bytes);
+        }
+      }
+      retired_.resize(kept);
+    }
+
+    /**
+     * @brief Number of blocks waiting for a grace period.
+     */
+    std::size_t pending() const noexcept { return retired_.size(); }
+
+  private:
+    struct alignas(64) Slot final
+    {
+      std::atomic<std::uint32_t> active[2]{};
+    };
+
+    struct Retired final
+    {
+      void *p;
+      std::size_t bytes;
+      std::uint64_t epoch;
+      /// Set for objects outside the arena.
+      void (*release)(void *);
+    };
+
+    bool try_advance() noexcept
+    {
+      const std::uint64_t now = epoch_.load();
+      const std::size_t previous = (now + 1) & 1u;
+
+      for (const Slot &slot : slots_)
+      {
+        if (slot.active[previous].load() != 0)
+        {
+          return false;
+        }
+      }
+
+      epoch_.store(now + 1);
+      return true;
+    }
+
+    mutable Slot slots_[slot_count]{};
+    std::atomic<std::uint64_t> epoch_{2};
+    std::vector<Retired> retired_{};
+  };
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_EPOCH_HPP
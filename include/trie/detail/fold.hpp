@@ -0,0 +1,128 @@
+/**
+ * @file fold.hpp
+ * @brief Case and diacritic folding of UTF-8 keys, one code point at a time.
+ *
+ * Notes:
+ * - ASCII letters fold to lowercase. Latin-1 Supplement and Latin Extended-A
+ *   letters (U+00C0..U+017F) fold to their lowercase base letters, ligatures
+ *   and sharp s to two letters ("Æ" -> "ae", "ß" -> "ss").
+ * - Every other byte is kept, so keys in other scripts and invalid UTF-8 pass
+ *   through unchanged.
+ * - Folding a string that ends on a code point boundary yields a prefix of
+ *   the folding of every string it starts, so folded prefix queries work.
+ */
+
+#ifndef TRIE_DETAIL_FOLD_HPP
+#define TRIE_DETAIL_FOLD_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace trie::detail
+{
+  /**
+   * @brief Folded form of one code point: up to two ASCII bytes.
+   */
+  struct FoldPiece final
+  {
+    char bytes[2]{};
+    std::uint8_t size{0};
+  };
+
+  inline constexpr char32_t fold_table_first = 0xC0;
+  inline constexpr char32_t fold_table_last = 0x17F;
+
+  /**
+   * @brief Folds of U+00C0..U+017F. Size 0 marks code points kept as they are (×, ÷).
+   */
+  inline constexpr auto latin_folds = []
+  {
+    struct Range
+    {
+      char32_t first;
+      char32_t last;
+      std::string_view fold;
+    };
+    constexpr Range ranges[] = {
+        {0xC0, 0xC5, "a"}, {0xC6, 0xC6, "ae"}, {0xC7, 0xC7, "c"}, {0xC8, 0xCB, "e"},
+        {0xCC, 0xCF, "i"}, {0xD0, 0xD0, "d"}, {0xD1, 0xD1, "n"}, {0xD2, 0xD6, "o"},
+        {0xD8, 0xD8, "o"}, {0xD9, 0xDC, "u"}, {0xDD, 0xDD, "y"}, {0xDE, 0xDE, "th"},
+        {0xDF, 0xDF, "ss"}, {0xE0, 0xE5, "a"}, {0xE6, 0xE6, "ae"}, {0xE7, 0xE7, "c"},
+        {0xE8, 0xEB, "e"}, {0xEC, 0xEF, "i"}, {0xF0, 0xF0, "d"}, {0xF1, 0xF1, "n"},
+        {0xF2, 0xF6, "o"}, {0xF8, 0xF8, "o"}, {0xF9, 0xFC, "u"}, {0xFD, 0xFD, "y"},
+        {0xFE, 0xFE, "th"}, {0xFF, 0xFF, "y"},
+        {0x100, 0x105, "a"}, {0x106, 0x10D, "c"}, {0x10E, 0x111, "d"}, {0x112, 0x11B, "e"},
+        {0x11C, 0x123, "g"}, {0x124, 0x127, "h"}, {0x128, 0x131, "i"}, {0x132, 0x133, "ij"},
+        {0x134, 0x135, "j"}, {0x136, 0x138, "k"}, {0x139, 0x142, "l"}, {0x143, 0x14B, "n"},
+        {0x14C, 0x151, "o"}, {0x152, 0x153, "oe"}, {0x154, 0x159, "r"}, {0x15A, 0x161, "s"},
+        {0x162, 0x167, "t"}, {0x168, 0x173, "u"}, {0x174, 0x175, "w"}, {0x176, 0x178, "y"},
+        {0x179, 0x17E, "z"}, {0x17F, 0x17F, "s"},
+    };
+
+    std::array<FoldPiece, fold_table_last - fold_table_first + 1> table{};
+    for (const Range &r : ranges)
+    {
+      for (char32_t cp = r.first; cp <= r.last; ++cp)
+      {
+        FoldPiece &p = table[cp - fold_table_first];
+        p.size = static_cast<std::uint8_t>(r.fold.size());
+        for (std::size_t i = 0; i < r.fold.size(); ++i)
+        {
+          p.bytes[i] = r.fold[i];
+        }
+      }
+    }
+    return table;
+  }();
+
+  /**
+   * @brief Call `step(char)` with each folded byte of @p s, in order. Stops once step returns false.
+   * @return false if a step returned false.
+   */
+  template <typename Step>
+  constexpr bool fold_each(std::string_view s, Step &&step)
+  {
+    for (std::size_t i = 0; i < s.size(); ++i)
+    {
+      const auto b = static_cast<unsigned char>(s[i]);
+      if (b < 0x80)
+      {
+        if (!step(static_cast<char>(b >= 'A' && b <= 'Z' ? b + ('a' - 'A') : b)))
+        {
+          return false;
+        }
+        continue;
+      }
+
+      // Two-byte sequences led by C3..C5 cover U+00C0..U+017F.
+      if (b >= 0xC3 && b <= 0xC5 && i + 1 < s.size() && (static_cast<unsigned char>(s[i + 1]) & 0xC0) == 0x80)
+      {
+        const char32_t cp = (char32_t{b} & 0x1F) << 6 | (static_cast<unsigned char>(s[i + 1]) & 0x3F);
+        const FoldPiece &p = latin_folds[cp - fold_table_first];
+        if (p.size != 0)
+        {
+          for (std::uint8_t k = 0; k < p.size; ++k)
+          {
+            if (!step(p.bytes[k]))
+            {
+              return false;
+            }
+          }
+          ++i;
+          continue;
+        }
+      }
+
+      if (!step(s[i]))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_FOLD_HPP
@@ -0,0 +1,99 @@
+/**
+ * @file parallel.hpp
+ * @brief Default executor for the parallel queries.
+ *
+ * Notes:
+ * - An executor is any callable `executor(std::size_t n, Task &&task)` that runs
+ *   `task(i)` for every i in [0, n), possibly concurrently, and returns once
+ *   all of them have finished. Plug a thread pool in through that shape.
+ * - ThreadExecutor starts n - 1 threads and runs task(0) on the caller.
+ */
+
+#ifndef TRIE_DETAIL_PARALLEL_HPP
+#define TRIE_DETAIL_PARALLEL_HPP
+
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trie::detail
+{
+  /**
+   * @brief Runs each task on its own std::thread. Rethrows the first task exception.
+   */
+  struct ThreadExecutor final
+  {
+    template <typename Task>
+    void operator()(std::size_t n, Task &&task) const
+    {
+      std::exception_ptr error;
+      std::mutex error_mtx;
+
+      const auto run = [&](std::size_t i)
+      {
+        try
+        {
+          task(i);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(error_mtx);
+          if (!error)
+          {
+            error = std::current_exception();
+          }
+        }
+      };
+
+      std::vector<std::thread> threads;
+      threads.reserve(n > 0 ? n - 1 : 0);
+      try
+      {
+        for (std::size_t i = 1; i < n; ++i)
+        {
+          threads.emplace_back(run, i);
+        }
+      }
+      catch (...)
+      {
+        for (std::thread &t : threads)
+        {
+          t.join();
+        }
+        throw;
+      }
+
+      if (n > 0)
+      {
+        run(0);
+      }
+      for (std::thread &t : threads)
+      {
+        t.join();
+      }
+
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+    }
+  };
+
+  /**
+   * @brief Number of workers to use when the caller asks for @p requested (0 = all cores).
+   */
+  inline std::size_t worker_count(std::size_t requested) noexcept
+  {
+    if (requested != 0)
+    {
+      return requested;
+    }
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw != 0 ? hw : 1;
+  }
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_PARALLEL_HPP
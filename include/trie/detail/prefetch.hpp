@@ -0,0 +1,31 @@
+/**
+ * @file prefetch.hpp
+ * @brief Portable software prefetch hint.
+ */
+
+#ifndef TRIE_DETAIL_PREFETCH_HPP
+#define TRIE_DETAIL_PREFETCH_HPP
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace trie::detail
+{
+  /**
+   * @brief Ask the CPU to start loading the cache line at @p p for reading. No-op if unsupported.
+   */
+  inline void prefetch(const void *p) noexcept
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char *>(p), _MM_HINT_T0);
+#else
+    (void)p;
+#endif
+  }
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_PREFETCH_HPP
@@ -0,0 +1,105 @@
+/**
+ * @file rw_lock.hpp
+ * @brief Read-optimized, writer-preferring reader-writer lock.
+ *
+ * Notes:
+ * - Readers increment a per-thread slot counter on its own cache line, so
+ *   concurrent readers never write to a shared location.
+ * - A writer raises a flag, then waits for every slot to drain. New readers
+ *   back off while the flag is up, so writers cannot be starved.
+ * - Writes are expensive (they scan every slot). Use for read-mostly data.
+ */
+
+#ifndef TRIE_DETAIL_RW_LOCK_HPP
+#define TRIE_DETAIL_RW_LOCK_HPP
+
+#include <trie/detail/thread_slot.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace trie::detail
+{
+  /**
+   * @brief Distributed reader-writer lock with SharedLockable/Lockable members.
+   */
+  class ReaderWriterLock final
+  {
+  public:
+    static constexpr std::size_t slot_count = 32;
+
+    ReaderWriterLock() = default;
+    ReaderWriterLock(const ReaderWriterLock &) = delete;
+    ReaderWriterLock &operator=(const ReaderWriterLock &) = delete;
+
+    void lock_shared() noexcept
+    {
+      Slot &slot = slots_[slot_index()];
+      for (;;)
+      {
+        slot.readers.fetch_add(1);
+        if (!writer_.load())
+        {
+          return;
+        }
+
+        release(slot);
+        writer_.wait(true);
+      }
+    }
+
+    void unlock_shared() noexcept
+    {
+      release(slots_[slot_index()]);
+    }
+
+    void lock()
+    {
+      writers_.lock();
+      writer_.store(true);
+
+      for (Slot &slot : slots_)
+      {
+        for (std::uint32_t n = slot.readers.load(); n != 0; n = slot.readers.load())
+        {
+          slot.readers.wait(n);
+        }
+      }
+    }
+
+    void unlock() noexcept
+    {
+      writer_.store(false);
+      writer_.notify_all();
+      writers_.unlock();
+    }
+
+  private:
+    struct alignas(64) Slot final
+    {
+      std::atomic<std::uint32_t> readers{0};
+    };
+
+    static std::size_t slot_index() noexcept
+    {
+      return thread_slot() % slot_count;
+    }
+
+    void release(Slot &slot) noexcept
+    {
+      if (slot.readers.fetch_sub(1) == 1 && writer_.load())
+      {
+        slot.readers.notify_all();
+      }
+    }
+
+    Slot slots_[slot_count]{};
+    std::atomic<bool> writer_{false};
+    std::mutex writers_;
+  };
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_RW_LOCK_HPP
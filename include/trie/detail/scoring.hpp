@@ -0,0 +1,306 @@
+/**
+ * @file scoring.hpp
+ * @brief Edit distance, ranking and visitor helpers shared by the trie query engines.
+ */
+
+#ifndef TRIE_DETAIL_SCORING_HPP
+#define TRIE_DETAIL_SCORING_HPP
+
+#include <trie/instrumentation.hpp>
+#include <trie/query_context.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace trie::detail
+{
+  /**
+   * @brief Call @p visit with @p word. Returns false if the visitor asked to stop.
+   */
+  template <typename Visitor>
+  constexpr bool emit(Visitor &visit, std::string_view word)
+  {
+    if constexpr (std::is_convertible_v<std::invoke_result_t<Visitor &, std::string_view>, bool>)
+    {
+      return static_cast<bool>(visit(word));
+    }
+    else
+    {
+      visit(word);
+      return true;
+    }
+  }
+
+  /**
+   * @brief Batch form of emit(): call `visit(index, word)`.
+   */
+  template <typename Visitor>
+  constexpr bool emit(Visitor &visit, std::size_t index, std::string_view word)
+  {
+    if constexpr (std::is_convertible_v<std::invoke_result_t<Visitor &, std::size_t, std::string_view>, bool>)
+    {
+      return static_cast<bool>(visit(index, word));
+    }
+    else
+    {
+      visit(index, word);
+      return true;
+    }
+  }
+
+  /**
+   * @brief Key-value form of emit(): call `visit(key, value)`.
+   */
+  template <typename Visitor, typename Value>
+  constexpr bool emit_entry(Visitor &visit, std::string_view key, Value &value)
+  {
+    if constexpr (std::is_convertible_v<std::invoke_result_t<Visitor &, std::string_view, Value &>, bool>)
+    {
+      return static_cast<bool>(visit(key, value));
+    }
+    else
+    {
+      visit(key, value);
+      return true;
+    }
+  }
+
+  /**
+   * @brief @p max_distance as a DP row bound. Distances past INT_MAX cannot occur, so larger bounds clamp to it.
+   */
+  constexpr int distance_bound(std::size_t max_distance) noexcept
+  {
+    return static_cast<int>(std::min<std::size_t>(max_distance, std::numeric_limits<int>::max()));
+  }
+
+  /**
+   * @brief Two-row Levenshtein distance. @p rows is scratch space.
+   */
+  inline int levenshtein_distance(std::string_view a, std::string_view b, std::vector<int> &rows)
+  {
+    const std::size_t m = a.size();
+    const std::size_t n = b.size();
+
+    if (m == 0)
+      return static_cast<int>(n);
+    if (n == 0)
+      return static_cast<int>(m);
+
+    count_dp_cells(m * n);
+    rows.resize(2 * (n + 1));
+    int *prev = rows.data();
+    int *cur = rows.data() + n + 1;
+
+    for (std::size_t j = 0; j <= n; ++j)
+    {
+      prev[j] = static_cast<int>(j);
+    }
+
+    for (std::size_t i = 1; i <= m; ++i)
+    {
+      cur[0] = static_cast<int>(i);
+      for (std::size_t j = 1; j <= n; ++j)
+      {
+        const int cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
+        cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + cost});
+      }
+      std::swap(prev, cur);
+    }
+
+    return prev[n];
+  }
+
+  /// Longest query the bit-parallel kernel handles. Longer queries use the DP rows.
+  inline constexpr std::size_t bit_parallel_max = 64;
+
+  /**
+   * @brief Build the match masks of @p query in sc.peq. Call after sc.reset().
+   *
+   * Bit i of sc.peq[c] is set when query[i] == c. Leaves sc.peq empty for
+   * queries longer than bit_parallel_max.
+   */
+  inline void prepare_distance(QueryScratch &sc, std::string_view query)
+  {
+    if (query.size() > bit_parallel_max)
+    {
+      sc.peq.clear();
+      return;
+    }
+    sc.peq.assign(256, 0);
+    for (std::size_t i = 0; i < query.size(); ++i)
+    {
+      sc.peq[static_cast<unsigned char>(query[i])] |= std::uint64_t{1} << i;
+    }
+  }
+
+  /**
+   * @brief Levenshtein distance between a query of @p m <= 64 bytes and @p text.
+   *
+   * Myers' bit-vector algorithm in Hyyrö's formulation: the DP column over the
+   * query is kept as vertical +1/-1 delta masks (pv, mv), so each text byte
+   * costs a constant number of 64-bit operations instead of m cell updates.
+   * @p peq holds the query's 256 match masks (see prepare_distance()).
+   */
+  inline int bit_parallel_distance(const std::uint64_t *peq, std::size_t m, std::string_view text) noexcept
+  {
+    if (m == 0)
+    {
+      return static_cast<int>(text.size());
+    }
+
+    count_dp_cells(m * text.size());
+    const std::uint64_t last = std::uint64_t{1} << (m - 1);
+    std::uint64_t pv = ~std::uint64_t{0};
+    std::uint64_t mv = 0;
+    int score = static_cast<int>(m);
+
+    for (char c : text)
+    {
+      const std::uint64_t eq = peq[static_cast<unsigned char>(c)];
+      const std::uint64_t xv = eq | mv;
+      const std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+
+      std::uint64_t ph = mv | ~(xh | pv);
+      std::uint64_t mh = pv & xh;
+      if (ph & last)
+        ++score;
+      else if (mh & last)
+        --score;
+
+      // Row 0 of the DP is 0, 1, 2, ...: its horizontal delta is always +1.
+      ph = (ph << 1) | 1u;
+      mh <<= 1;
+      pv = mh | ~(xv | ph);
+      mv = ph & xv;
+    }
+    return score;
+  }
+
+  /**
+   * @brief Distance between @p query and @p word, bit-parallel when sc.peq is prepared.
+   */
+  inline int levenshtein_distance(std::string_view query, std::string_view word, QueryScratch &sc)
+  {
+    if (!sc.peq.empty())
+    {
+      return bit_parallel_distance(sc.peq.data(), query.size(), word);
+    }
+    return levenshtein_distance(query, word, sc.rows);
+  }
+
+  /**
+   * @brief Fill @p row, the DP row after appending byte @p c, from @p prev.
+   * @return Minimum of the new row.
+   */
+  inline int levenshtein_step(std::string_view query, const int *prev, int *row, char c) noexcept
+  {
+    count_dp_cells(query.size());
+    row[0] = prev[0] + 1;
+    int row_min = row[0];
+    for (std::size_t j = 1; j <= query.size(); ++j)
+    {
+      const int cost = (query[j - 1] == c) ? 0 : 1;
+      row[j] = std::min({prev[j] + 1, row[j - 1] + 1, prev[j - 1] + cost});
+      row_min = std::min(row_min, row[j]);
+    }
+    return row_min;
+  }
+
+  /**
+   * @brief @p a + @p b, saturating at the largest count instead of wrapping.
+   */
+  constexpr std::uint64_t saturating_add(std::uint64_t a, std::uint64_t b) noexcept
+  {
+    return a > std::numeric_limits<std::uint64_t>::max() - b ? std::numeric_limits<std::uint64_t>::max() : a + b;
+  }
+
+  /**
+   * @brief Ranking score shared by search_ranked() and search_fuzzy().
+   */
+  inline double score_distance(int d, std::size_t word_size, std::uint64_t frequency) noexcept
+  {
+    const double sim = 1.0 / (1.0 + static_cast<double>(d));
+    const double len_bonus = static_cast<double>(word_size) * 0.02;
+    const double freq_bonus = static_cast<double>(frequency) * 0.05;
+
+    return sim + len_bonus + freq_bonus;
+  }
+
+  /**
+   * @brief Result order: higher score first, then lexicographic.
+   */
+  inline bool scored_before(const ScoredWord &a, const ScoredWord &b) noexcept
+  {
+    if (a.score != b.score)
+      return a.score > b.score;
+    return a.word < b.word;
+  }
+
+  /**
+   * @brief Offer sc.key with @p score as a candidate.
+   *
+   * Without a limit every candidate is kept. With sc.limit set only the best
+   * sc.limit are: a full buffer is a heap with the worst kept candidate in
+   * front, and a candidate that does not beat it is dropped before its key is
+   * copied. Slots reuse the string capacity of earlier queries.
+   */
+  inline void push_scored(QueryScratch &sc, double score)
+  {
+    count_scored();
+    if (sc.limit != 0 && sc.scored_size == sc.limit)
+    {
+      const ScoredWord &worst = sc.scored.front();
+      if (score < worst.score || (score == worst.score && !(std::string_view(sc.key) < worst.word)))
+      {
+        return;
+      }
+      std::pop_heap(sc.scored.begin(), sc.scored.begin() + static_cast<std::ptrdiff_t>(sc.scored_size), scored_before);
+      --sc.scored_size;
+    }
+
+    if (sc.scored_size == sc.scored.size())
+    {
+      sc.scored.emplace_back();
+    }
+    ScoredWord &slot = sc.scored[sc.scored_size++];
+    slot.word.assign(sc.key);
+    slot.score = score;
+
+    if (sc.limit != 0)
+    {
+      std::push_heap(sc.scored.begin(), sc.scored.begin() + static_cast<std::ptrdiff_t>(sc.scored_size), scored_before);
+    }
+  }
+
+  /**
+   * @brief Sort the recorded candidates and visit the best @p limit of them.
+   */
+  template <typename Visitor>
+  std::size_t emit_ranked(QueryScratch &sc, std::size_t limit, Visitor &visit)
+  {
+    const auto first = sc.scored.begin();
+    const auto last = first + static_cast<std::ptrdiff_t>(sc.scored_size);
+
+    std::sort(first, last, scored_before);
+
+    const std::size_t take = (limit == 0) ? sc.scored_size : std::min(limit, sc.scored_size);
+
+    for (std::size_t i = 0; i < take; ++i)
+    {
+      if (!emit(visit, sc.scored[i].word))
+      {
+        return i + 1;
+      }
+    }
+    return take;
+  }
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_SCORING_HPP
@@ -0,0 +1,94 @@
+/**
+ * @file sorted_input.hpp
+ * @brief Element access and order checking for the sorted bulk builders.
+ *
+ * Notes:
+ * - A sorted input element is either a word (anything convertible to
+ *   std::string_view) or a pair-like (word, frequency). Negative counts are
+ *   rejected.
+ * - A SortedEntry views the element it was read from. Ranges that yield
+ *   elements by value invalidate it at the next iteration.
+ * - Order is ascending unsigned byte order, the order suggest() returns.
+ *   Repeated words are allowed and add up their frequencies.
+ */
+
+#ifndef TRIE_DETAIL_SORTED_INPUT_HPP
+#define TRIE_DETAIL_SORTED_INPUT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace trie::detail
+{
+  /**
+   * @brief One element of a sorted input: the word and how often it occurs.
+   */
+  struct SortedEntry final
+  {
+    std::string_view word;
+    std::uint64_t frequency;
+  };
+
+  template <typename T>
+  SortedEntry sorted_entry(const T &element)
+  {
+    if constexpr (std::is_convertible_v<const T &, std::string_view>)
+    {
+      return SortedEntry{std::string_view(element), 1};
+    }
+    else
+    {
+      const auto &[word, frequency] = element;
+      if constexpr (std::is_signed_v<std::remove_cvref_t<decltype(frequency)>>)
+      {
+        if (frequency < 0)
+        {
+          throw std::invalid_argument("trie: word count is negative");
+        }
+      }
+      return SortedEntry{std::string_view(word), static_cast<std::uint64_t>(frequency)};
+    }
+  }
+
+  /**
+   * @brief Whether the elements of @p Range outlive the iteration that reads them.
+   *
+   * False for ranges that yield by value, such as a transform view; words
+   * kept past one iteration must then be copied.
+   */
+  template <typename Range>
+  inline constexpr bool yields_lvalues_v = std::is_lvalue_reference_v<std::ranges::range_reference_t<const Range &>>;
+
+  /**
+   * @brief Length of the common prefix of @p previous and @p word.
+   *
+   * Throws std::invalid_argument if @p word sorts before @p previous.
+   */
+  inline std::size_t sorted_common_prefix(std::string_view previous, std::string_view word)
+  {
+    const std::size_t n = std::min(previous.size(), word.size());
+    std::size_t i = 0;
+    while (i < n && previous[i] == word[i])
+    {
+      ++i;
+    }
+
+    const bool ordered = (i == n)
+                             ? previous.size() <= word.size()
+                             : static_cast<unsigned char>(previous[i]) < static_cast<unsigned char>(word[i]);
+    if (!ordered)
+    {
+      throw std::invalid_argument("trie: sorted input is out of order");
+    }
+    return i;
+  }
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_SORTED_INPUT_HPP
@@ -0,0 +1,28 @@
+/**
+ * @file thread_slot.hpp
+ * @brief Stable per-thread index used to spread threads over padded counters.
+ */
+
+#ifndef TRIE_DETAIL_THREAD_SLOT_HPP
+#define TRIE_DETAIL_THREAD_SLOT_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace trie::detail
+{
+  /**
+   * @brief Return a number assigned to the calling thread on first use.
+   *
+   * Threads get consecutive numbers, so `thread_slot() % n` spreads them evenly.
+   */
+  inline std::size_t thread_slot() noexcept
+  {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+  }
+
+} // namespace trie::detail
+
+#endif // TRIE_DETAIL_THREAD_SLOT_HPP
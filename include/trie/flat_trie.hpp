@@ -0,0 +1,783 @@
+/**
+ * @file flat_trie.hpp
+ * @brief Compact, position-independent trie image and a read-only view over it.
+ *
+ * Notes:
+ * - An image is a header followed by a node array and a label array. Nodes
+ *   refer to their children by 32-bit index, and the children of a node are
+ *   contiguous and sorted by label, so the image can be mapped at any address.
+ * - Where the children blocks go is up to the writer (flat::Layout). Readers
+ *   only follow indices, so every layout answers the same.
+ * - Integers are stored in host byte order. The header records the byte order
+ *   and an image written on a machine of the other order is rejected.
+ * - FlatTrieView answers the Trie queries directly from the bytes, with the same
+ *   results and ranking.
+ */
+
+#ifndef TRIE_FLAT_TRIE_HPP
+#define TRIE_FLAT_TRIE_HPP
+
+#include <trie/detail/scoring.hpp>
+#include <trie/detail/sorted_input.hpp>
+#include <trie/query_context.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace trie
+{
+  namespace flat
+  {
+    inline constexpr char magic[8] = {'T', 'R', 'I', 'E', 'F', 'L', 'A', 'T'};
+    inline constexpr std::uint32_t version = 1;
+    inline constexpr std::uint32_t byte_order_mark = 0x01020304u;
+
+    /// Node flag: the node ends a word.
+    inline constexpr std::uint8_t terminal = 1u;
+
+    /**
+     * @brief Image header. Sections follow in order: nodes, then labels.
+     */
+    struct Header final
+    {
+      char magic[8];
+      std::uint32_t version;
+      std::uint32_t byte_order;
+      std::uint32_t node_count;
+      std::uint32_t root;
+      std::uint64_t word_count;
+      std::uint64_t image_size;
+      std::uint64_t reserved;
+    };
+
+    /**
+     * @brief One node. Its children are nodes [first_child, first_child + child_count).
+     */
+    struct Node final
+    {
+      std::uint32_t first_child;
+      std::uint16_t child_count;
+      std::uint8_t flags;
+      std::uint8_t reserved;
+      std::uint64_t frequency;
+      std::uint64_t max_frequency;
+    };
+
+    static_assert(sizeof(Header) == 48);
+    static_assert(sizeof(Node) == 24);
+
+    /**
+     * @brief Size in bytes of an image holding @p node_count nodes.
+     */
+    constexpr std::size_t image_size(std::size_t node_count) noexcept
+    {
+      const std::size_t labels = (node_count + 7u) & ~std::size_t{7};
+      return sizeof(Header) + node_count * sizeof(Node) + labels;
+    }
+
+    /**
+     * @brief Write a header for @p node_count nodes into @p image.
+     */
+    inline void write_header(std::byte *image, std::uint32_t node_count, std::uint32_t root, std::uint64_t word_count) noexcept
+    {
+      Header h{};
+      std::memcpy(h.magic, magic, sizeof(magic));
+      h.version = version;
+      h.byte_order = byte_order_mark;
+      h.node_count = node_count;
+      h.root = root;
+      h.word_count = word_count;
+      h.image_size = image_size(node_count);
+      std::memcpy(image, &h, sizeof(h));
+    }
+
+    /**
+     * @brief Placement of the children blocks in an image written by flatten().
+     */
+    enum class Layout : std::uint8_t
+    {
+      /// Level by level: the children of consecutive nodes are adjacent.
+      breadth_first,
+      /// Block by block, depth-first: a node's children follow its parent's
+      /// block, the child with the highest max_frequency first, so the hottest
+      /// lookups walk consecutive memory instead of one level row per byte.
+      hot_path,
+    };
+
+    /**
+     * @brief Serialize a pointer trie rooted at @p root, in @p layout order.
+     *
+     * @p TreeNode must expose `children` (iterable as (char, TreeNode*) in label order),
+     * `is_terminal`, `frequency` and `max_frequency`.
+     */
+    template <typename TreeNode>
+    std::vector<std::byte> flatten(const TreeNode *root, Layout layout = Layout::breadth_first)
+    {
+      std::vector<const TreeNode *> order;
+      std::vector<unsigned char> labels;
+      std::vector<std::uint32_t> first_child;
+      order.push_back(root);
+      labels.push_back(0);
+      first_child.push_back(0);
+
+      // Nodes whose children are not placed yet: a queue for breadth_first, a
+      // stack for hot_path. Placing a node appends its children contiguously,
+      // in label order.
+      std::vector<std::uint32_t> pending{0};
+      std::size_t head = 0;
+      while (layout == Layout::breadth_first ? head < pending.size() : !pending.empty())
+      {
+        std::uint32_t i = 0;
+        if (layout == Layout::breadth_first)
+        {
+          i = pending[head++];
+        }
+        else
+        {
+          i = pending.back();
+          pending.pop_back();
+        }
+
+        if (order.size() + order[i]->children.size() > std::numeric_limits<std::uint32_t>::max())
+        {
+          throw std::length_error("trie: too many nodes for a flat image");
+        }
+        const auto mark = static_cast<std::uint32_t>(order.size());
+        first_child[i] = mark;
+        for (const auto &kv : order[i]->children)
+        {
+          pending.push_back(static_cast<std::uint32_t>(order.size()));
+          order.push_back(kv.second);
+          labels.push_back(static_cast<unsigned char>(kv.first));
+          first_child.push_back(0);
+        }
+
+        if (layout == Layout::hot_path)
+        {
+          // The last pushed pops first: hottest child, then lowest label on ties.
+          std::sort(pending.end() - static_cast<std::ptrdiff_t>(order.size() - mark), pending.end(),
+                    [&order](std::uint32_t a, std::uint32_t b)
+                    {
+                      if (order[a]->max_frequency != order[b]->max_frequency)
+                        return order[a]->max_frequency < order[b]->max_frequency;
+                      return a > b;
+                    });
+        }
+      }
+
+      const std::size_t n = order.size();
+      std::vector<std::byte> image(image_size(n));
+
+      auto *nodes = reinterpret_cast<Node *>(image.data() + sizeof(Header));
+      auto *label_out = reinterpret_cast<unsigned char *>(nodes + n);
+
+      std::uint64_t words = 0;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        const TreeNode *src = order[i];
+        Node &dst = nodes[i];
+        dst.first_child = first_child[i];
+        dst.child_count = static_cast<std::uint16_t>(src->children.size());
+        dst.flags = src->is_terminal ? terminal : 0u;
+        dst.reserved = 0;
+        dst.frequency = src->frequency;
+        dst.max_frequency = src->max_frequency;
+        label_out[i] = labels[i];
+        words += src->is_terminal ? 1u : 0u;
+      }
+
+      write_header(image.data(), static_cast<std::uint32_t>(n), 0, words);
+      return image;
+    }
+
+    /**
+     * @brief Build a flat image from words in sorted order, in one pass.
+     *
+     * No pointer trie is built. Nodes are finalized in post-order: when a node
+     * can get no more children, its children are written as one contiguous block
+     * and the root is written last. Memory besides the image is proportional to
+     * the longest word times the fanout along it.
+     *
+     * Words must be added in ascending unsigned byte order. A repeated word adds
+     * to the frequency of the previous one.
+     */
+    class SortedBuilder final
+    {
+    public:
+      SortedBuilder()
+      {
+        pending_.push_back(Pending{Node{}, 0});
+        starts_.push_back(1);
+      }
+
+      /**
+       * @brief Add @p word. Throws std::invalid_argument if it sorts before the previous word.
+       */
+      void add(std::string_view word, std::uint64_t frequency = 1)
+      {
+        const std::size_t common = detail::sorted_common_prefix(key_, word);
+
+        while (key_.size() > common)
+        {
+          finalize_top();
+          key_.pop_back();
+        }
+
+        for (std::size_t i = common; i < word.size(); ++i)
+        {
+          pending_.push_back(Pending{Node{}, static_cast<unsigned char>(word[i])});
+          starts_.push_back(pending_.size());
+          key_.push_back(word[i]);
+        }
+
+        Node &node = pending_[starts_.back() - 1].node;
+        if ((node.flags & terminal) == 0)
+        {
+          node.flags |= terminal;
+          ++word_count_;
+        }
+        node.frequency = detail::saturating_add(node.frequency, frequency);
+        node.max_frequency = std::max(node.max_frequency, node.frequency);
+      }
+
+      /**
+       * @brief Finish the image. The builder is empty afterwards.
+       */
+      std::vector<std::byte> finish()
+      {
+        while (!key_.empty())
+        {
+          finalize_top();
+          key_.pop_back();
+        }
+        finalize_top();
+
+        const std::uint32_t root = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.push_back(pending_.front().node);
+        labels_.push_back(0);
+
+        const std::size_t n = nodes_.size();
+        std::vector<std::byte> image(image_size(n));
+        std::memcpy(image.data() + sizeof(Header), nodes_.data(), n * sizeof(Node));
+        std::memcpy(image.data() + sizeof(Header) + n * sizeof(Node), labels_.data(), n);
+        write_header(image.data(), static_cast<std::uint32_t>(n), root, word_count_);
+
+        *this = SortedBuilder();
+        return image;
+      }
+
+    private:
+      struct Pending final
+      {
+        Node node;
+        unsigned char label;
+      };
+
+      /**
+       * @brief Write the children of the deepest open node and close its child list.
+       */
+      void finalize_top()
+      {
+        const std::size_t first = starts_.back();
+        starts_.pop_back();
+
+        Node &parent = pending_[first - 1].node;
+        if (nodes_.size() + (pending_.size() - first) >= std::numeric_limits<std::uint32_t>::max())
+        {
+          throw std::length_error("trie: too many nodes for a flat image");
+        }
+
+        parent.first_child = static_cast<std::uint32_t>(nodes_.size());
+        parent.child_count = static_cast<std::uint16_t>(pending_.size() - first);
+        for (std::size_t i = first; i < pending_.size(); ++i)
+        {
+          parent.max_frequency = std::max(parent.max_frequency, pending_[i].node.max_frequency);
+          nodes_.push_back(pending_[i].node);
+          labels_.push_back(pending_[i].label);
+        }
+        pending_.resize(first);
+      }
+
+      std::string key_{};
+      std::vector<Pending> pending_{};
+      std::vector<std::size_t> starts_{};
+      std::vector<Node> nodes_{};
+      std::vector<unsigned char> labels_{};
+      std::uint64_t word_count_{0};
+    };
+
+    /**
+     * @brief Build a flat image from a sorted range of words or (word, frequency) pairs.
+     */
+    template <typename Range>
+    std::vector<std::byte> build_from_sorted(const Range &words)
+    {
+      SortedBuilder builder;
+      for (const auto &element : words)
+      {
+        const detail::SortedEntry e = detail::sorted_entry(element);
+        builder.add(e.word, e.frequency);
+      }
+      return builder.finish();
+    }
+
+  } // namespace flat
+
+  /**
+   * @brief Read-only trie over a flat image. Does not own the bytes.
+   *
+   * Construction checks the header and section sizes in O(1). The node data is
+   * trusted; call verify() once for images from untrusted sources.
+   *
+   * Features:
+   * - contains(word), frequency(word)
+   * - suggest(prefix, limit)
+   * - suggest_top(prefix, k)
+   * - search_ranked(query, limit)
+   * - search_fuzzy(query, max_distance, limit)
+   *
+   * Thread safety:
+   * - All members are const and lock-free. Any number of threads may query one view.
+   */
+  class FlatTrieView
+  {
+  public:
+    FlatTrieView() = default;
+
+    /**
+     * @brief View @p image. Throws std::invalid_argument if the header is not valid.
+     */
+    explicit FlatTrieView(std::span<const std::byte> image)
+    {
+      if (image.size() < sizeof(flat::Header))
+      {
+        throw std::invalid_argument("trie: flat image is too small");
+      }
+      if (reinterpret_cast<std::uintptr_t>(image.data()) % alignof(flat::Node) != 0)
+      {
+        throw std::invalid_argument("trie: flat image is not 8-byte aligned");
+      }
+
+      flat::Header h;
+      std::memcpy(&h, image.data(), sizeof(h));
+
+      if (std::memcmp(h.magic, flat::magic, sizeof(flat::magic)) != 0)
+      {
+        throw std::invalid_argument("trie: not a flat trie image");
+      }
+      if (h.byte_order != flat::byte_order_mark)
+      {
+        throw std::invalid_argument("trie: flat image has a different byte order");
+      }
+      if (h.version != flat::version)
+      {
+        throw std::invalid_argument("trie: unsupported flat image version");
+      }
+      if (h.node_count == 0 || h.root >= h.node_count ||
+          h.image_size != flat::image_size(h.node_count) || image.size() < h.image_size)
+      {
+        throw std::invalid_argument("trie: corrupt flat image header");
+      }
+
+      nodes_ = reinterpret_cast<const flat::Node *>(image.data() + sizeof(flat::Header));
+      labels_ = reinterpret_cast<const unsigned char *>(nodes_ + h.node_count);
+      node_count_ = h.node_count;
+      root_ = h.root;
+      word_count_ = h.word_count;
+    }
+
+    /**
+     * @brief Number of words in the image.
+     */
+    std::uint64_t size() const noexcept { return word_count_; }
+
+    /**
+     * @brief Number of nodes in the image.
+     */
+    std::uint32_t node_count() const noexcept { return node_count_; }
+
+    /**
+     * @brief Check every child range, and that the nodes form a tree. O(nodes), one bit per node.
+     *
+     * Each node may be the child of at most one node and the root of none, so
+     * every walk from the root is finite, whatever the layout.
+     */
+    bool verify() const
+    {
+      std::vector<bool> has_parent(node_count_, false);
+      for (std::uint32_t i = 0; i < node_count_; ++i)
+      {
+        const flat::Node &n = nodes_[i];
+        if (static_cast<std::uint64_t>(n.first_child) + n.child_count > node_count_)
+        {
+          return false;
+        }
+        for (std::uint32_t c = 0; c < n.child_count; ++c)
+        {
+          const std::uint32_t child = n.first_child + c;
+          if (child == root_ || has_parent[child])
+          {
+            return false;
+          }
+          has_parent[child] = true;
+          if (c != 0 && labels_[child - 1] >= labels_[child])
+          {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    bool contains(std::string_view word) const noexcept
+    {
+      if (!nodes_)
+      {
+        return false;
+      }
+      std::uint32_t node = root_;
+      for (char c : word)
+      {
+        node = find_child(node, c);
+        if (node == npos)
+        {
+          return false;
+        }
+      }
+      return (nodes_[node].flags & flat::terminal) != 0;
+    }
+
+    /**
+     * @brief Frequency of a word, 0 if it is not in the image.
+     */
+    std::uint64_t frequency(std::string_view word) const noexcept
+    {
+      const std::uint32_t node = locate(word);
+      if (node == npos || !(nodes_[node].flags & flat::terminal))
+      {
+        return 0;
+      }
+      return nodes_[node].frequency;
+    }
+
+    std::vector<std::string> suggest(std::string_view prefix, std::size_t limit = 0) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      suggest(prefix, limit, ctx, [&out](std::string_view word)
+              { out.emplace_back(word); });
+      return out;
+    }
+
+    template <typename Visitor>
+    std::size_t suggest(std::string_view prefix, std::size_t limit, QueryContext &ctx, Visitor &&visit) const
+    {
+      const std::uint32_t node = locate(prefix);
+      if (node == npos)
+      {
+        return 0;
+      }
+
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      sc.key.assign(prefix);
+      std::size_t count = 0;
+      collect_suggestions(node, sc, limit, count, visit);
+      return count;
+    }
+
+    std::vector<std::string> suggest_top(std::string_view prefix, std::size_t k) const
+    {
+      const std::uint32_t start = locate(prefix);
+      if (start == npos)
+      {
+        return {};
+      }
+
+      struct Entry final
+      {
+        std::uint64_t bound;
+        bool is_word;
+        std::uint32_t node;
+        std::string key;
+      };
+
+      const auto worse = [](const Entry &a, const Entry &b)
+      {
+        if (a.bound != b.bound)
+          return a.bound < b.bound;
+        return a.key > b.key;
+      };
+
+      std::priority_queue<Entry, std::vector<Entry>, decltype(worse)> frontier(worse);
+      std::vector<std::string> out;
+
+      frontier.push(Entry{nodes_[start].max_frequency, false, start, std::string(prefix)});
+
+      while (!frontier.empty() && (k == 0 || out.size() < k))
+      {
+        Entry top = frontier.top();
+        frontier.pop();
+
+        if (top.is_word)
+        {
+          out.push_back(std::move(top.key));
+          continue;
+        }
+
+        const flat::Node &n = nodes_[top.node];
+        if (n.flags & flat::terminal)
+        {
+          frontier.push(Entry{n.frequency, true, 0, top.key});
+        }
+
+        for (std::uint32_t c = n.first_child; c < n.first_child + n.child_count; ++c)
+        {
+          std::string key = top.key;
+          key.push_back(static_cast<char>(labels_[c]));
+          frontier.push(Entry{nodes_[c].max_frequency, false, c, std::move(key)});
+        }
+      }
+
+      return out;
+    }
+
+    std::vector<std::string> search_ranked(std::string_view query, std::size_t limit = 10) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      search_ranked(query, limit, ctx, [&out](std::string_view word)
+                    { out.emplace_back(word); });
+      return out;
+    }
+
+    template <typename Visitor>
+    std::size_t search_ranked(std::string_view query, std::size_t limit, QueryContext &ctx, Visitor &&visit) const
+    {
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      sc.reset(limit);
+      detail::prepare_distance(sc, query);
+      if (nodes_)
+      {
+        collect_scored(root_, sc, query);
+      }
+      return detail::emit_ranked(sc, limit, visit);
+    }
+
+    std::vector<std::string> search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit = 10) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      search_fuzzy(query, max_distance, limit, ctx, [&out](std::string_view word)
+                   { out.emplace_back(word); });
+      return out;
+    }
+
+    template <typename Visitor>
+    std::size_t search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit,
+        QueryContext &ctx,
+        Visitor &&visit) const
+    {
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+
+      const std::size_t width = query.size() + 1;
+      sc.rows.resize(width);
+      for (std::size_t j = 0; j < width; ++j)
+      {
+        sc.rows[j] = static_cast<int>(j);
+      }
+      sc.reset(limit);
+
+      if (!nodes_)
+      {
+        return 0;
+      }
+
+      const flat::Node &root = nodes_[root_];
+      if ((root.flags & flat::terminal) && query.size() <= max_distance)
+      {
+        detail::push_scored(sc, detail::score_distance(static_cast<int>(query.size()), 0, root.frequency));
+      }
+
+      collect_fuzzy(sc, query, detail::distance_bound(max_distance));
+
+      return detail::emit_ranked(sc, limit, visit);
+    }
+
+  private:
+    static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+    std::uint32_t find_child(std::uint32_t node, char c) const noexcept
+    {
+      const flat::Node &n = nodes_[node];
+      const unsigned char *first = labels_ + n.first_child;
+      const unsigned char *last = first + n.child_count;
+      const auto key = static_cast<unsigned char>(c);
+
+      const unsigned char *it = (n.child_count <= 8)
+                                    ? std::find(first, last, key)
+                                    : std::lower_bound(first, last, key);
+      if (it == last || *it != key)
+      {
+        return npos;
+      }
+      return static_cast<std::uint32_t>(it - labels_);
+    }
+
+    std::uint32_t locate(std::string_view prefix) const noexcept
+    {
+      if (!nodes_)
+      {
+        return npos;
+      }
+      std::uint32_t node = root_;
+      for (char c : prefix)
+      {
+        node = find_child(node, c);
+        if (node == npos)
+        {
+          return npos;
+        }
+      }
+      return node;
+    }
+
+    /**
+     * @brief Visit the words below @p start in byte order; sc.key holds its key.
+     *
+     * Iterative preorder walk on sc.stack. sc.key is restored before returning.
+     */
+    template <typename Visitor>
+    bool collect_suggestions(
+        std::uint32_t start,
+        detail::QueryScratch &sc,
+        std::size_t limit,
+        std::size_t &count,
+        Visitor &visit) const
+    {
+      const std::size_t base = sc.key.size();
+      sc.stack.clear();
+
+      bool more = true;
+      for (std::uint32_t node = start; node != npos; node = next_frame(sc))
+      {
+        const flat::Node &n = nodes_[node];
+        if (n.flags & flat::terminal)
+        {
+          ++count;
+          if (!detail::emit(visit, sc.key) || (limit != 0 && count >= limit))
+          {
+            more = false;
+            break;
+          }
+        }
+        push_children(sc, n);
+      }
+
+      sc.key.resize(base);
+      return more;
+    }
+
+    void collect_scored(std::uint32_t start, detail::QueryScratch &sc, std::string_view query) const
+    {
+      const std::size_t base = sc.key.size();
+      sc.stack.clear();
+
+      for (std::uint32_t node = start; node != npos; node = next_frame(sc))
+      {
+        const flat::Node &n = nodes_[node];
+        if (n.flags & flat::terminal)
+        {
+          const int d = detail::levenshtein_distance(query, sc.key, sc);
+          detail::push_scored(sc, detail::score_distance(d, sc.key.size(), n.frequency));
+        }
+        push_children(sc, n);
+      }
+
+      sc.key.resize(base);
+    }
+
+    /**
+     * @brief Bounded fuzzy walk below the root, one DP row per depth. sc.key must be empty.
+     */
+    void collect_fuzzy(detail::QueryScratch &sc, std::string_view query, int max_distance) const
+    {
+      const std::size_t width = query.size() + 1;
+
+      sc.stack.clear();
+      push_children(sc, nodes_[root_]);
+      for (std::uint32_t node = next_frame(sc); node != npos; node = next_frame(sc))
+      {
+        const std::size_t depth = sc.key.size();
+        sc.rows.resize((depth + 1) * width);
+        int *row = sc.rows.data() + depth * width;
+        const int row_min = detail::levenshtein_step(query, row - width, row, sc.key.back());
+
+        const flat::Node &n = nodes_[node];
+        if ((n.flags & flat::terminal) && row[width - 1] <= max_distance)
+        {
+          detail::push_scored(sc, detail::score_distance(row[width - 1], depth, n.frequency));
+        }
+        if (row_min <= max_distance)
+        {
+          push_children(sc, n);
+        }
+      }
+
+      sc.key.clear();
+    }
+
+    /**
+     * @brief Queue the children of @p n, keyed after sc.key, to pop in byte order.
+     */
+    static void push_children(detail::QueryScratch &sc, const flat::Node &n)
+    {
+      const auto key_size = static_cast<std::uint32_t>(sc.key.size());
+      for (std::uint32_t c = n.first_child + n.child_count; c-- > n.first_child;)
+      {
+        sc.stack.push_back(detail::Frame{c, key_size, 0});
+      }
+    }
+
+    /**
+     * @brief Pop the next node of the walk and set sc.key to its key, or return npos.
+     */
+    std::uint32_t next_frame(detail::QueryScratch &sc) const
+    {
+      if (sc.stack.empty())
+      {
+        return npos;
+      }
+      const detail::Frame f = sc.stack.back();
+      sc.stack.pop_back();
+      const auto node = static_cast<std::uint32_t>(f.node);
+      sc.key.resize(f.key_size);
+      sc.key.push_back(static_cast<char>(labels_[node]));
+      return node;
+    }
+
+    const flat::Node *nodes_{nullptr};
+    const unsigned char *labels_{nullptr};
+    std::uint32_t node_count_{0};
+    std::uint32_t root_{0};
+    std::uint64_t word_count_{0};
+  };
+
+} // namespace trie
+
+#endif // TRIE_FLAT_TRIE_HPP
@@ -0,0 +1,407 @@
+/**
+ * @file folded_trie.hpp
+ * @brief Case- and accent-insensitive trie that still returns words as inserted.
+ *
+ * Notes:
+ * - Nodes are keyed by folded bytes (see detail/fold.hpp), so "Café", "cafe"
+ *   and "CAFÉ" end at one node. That node keeps each original spelling, with
+ *   its own frequency, as its terminal payload.
+ * - Queries are folded byte by byte while they walk down from the root. No
+ *   folded copy of the query is built, so a lookup costs what an exact one
+ *   does.
+ * - Results are spellings: in folded key order, the spellings of one key in
+ *   byte order.
+ */
+
+#ifndef TRIE_FOLDED_TRIE_HPP
+#define TRIE_FOLDED_TRIE_HPP
+
+#include <trie/detail/arena.hpp>
+#include <trie/detail/child_map.hpp>
+#include <trie/detail/fold.hpp>
+#include <trie/detail/scoring.hpp>
+#include <trie/instrumentation.hpp>
+#include <trie/query_context.hpp>
+#include <trie/stats.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace trie
+{
+  /**
+   * @brief Folded key of @p word, as FoldedTrie indexes it.
+   */
+  inline std::string fold(std::string_view word)
+  {
+    std::string out;
+    out.reserve(word.size());
+    detail::fold_each(word, [&out](char c)
+                      { out.push_back(c);
+                        return true; });
+    return out;
+  }
+
+  /**
+   * @brief One original spelling. Its bytes follow the struct in the arena.
+   */
+  struct FoldedSpelling final
+  {
+    FoldedSpelling *next{nullptr};
+    std::uint64_t frequency{0};
+    std::uint32_t size{0};
+
+    std::string_view word() const noexcept { return {reinterpret_cast<const char *>(this + 1), size}; }
+  };
+
+  /**
+   * @brief FoldedTrie node. Terminal nodes list their spellings in byte order.
+   */
+  struct FoldedNode final
+  {
+    detail::ChildMap<FoldedNode> children{};
+    /// Null unless the node is terminal.
+    FoldedSpelling *spellings{nullptr};
+    /// Highest spelling frequency in this node's subtree, including itself.
+    std::uint64_t max_frequency{0};
+  };
+
+  static_assert(std::is_trivially_destructible_v<FoldedNode> && std::is_trivially_destructible_v<FoldedSpelling>,
+                "folded nodes are released with their arena and never destructed");
+
+  /**
+   * @brief Autocomplete over folded keys, answering with original spellings.
+   *
+   * Features:
+   * - insert(word), insert(word, weight)
+   * - contains(word), spellings(word)
+   * - suggest(prefix, limit), suggest_top(prefix, k)
+   * - size(), stats()
+   *
+   * Thread safety:
+   * - By default, this class is NOT thread-safe.
+   * - Pass thread_safe=true to lock an internal mutex around every operation.
+   */
+  class FoldedTrie final
+  {
+  public:
+    /**
+     * @brief Construct an empty folded trie.
+     * @param thread_safe If true, operations lock an internal mutex.
+     * @param resource Upstream memory resource for nodes and spellings.
+     */
+    explicit FoldedTrie(bool thread_safe = false,
+                        std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : arena_(resource),
+          root_(arena_.create<FoldedNode>()),
+          thread_safe_(thread_safe)
+    {
+    }
+
+    void insert(std::string_view word) { insert(word, 1); }
+
+    /**
+     * @brief Insert @p word under its folded key, or raise its frequency by @p weight.
+     *
+     * Spellings are kept byte for byte: "Café" and "café" are two spellings of
+     * one key, each with its own frequency.
+     */
+    void insert(std::string_view word, std::uint64_t weight)
+    {
+      detail::ScopedOperation measure(Operation::insert);
+      LockGuard lock(*this);
+
+      FoldedNode *node = root_;
+      detail::fold_each(word, [&](char c)
+                        {
+        detail::count_nodes(1);
+        FoldedNode *next = node->children.find(c);
+        if (!next)
+        {
+          next = arena_.create<FoldedNode>();
+          node->children.emplace(c, next, arena_);
+        }
+        node = next;
+        return true; });
+
+      FoldedSpelling **link = &node->spellings;
+      while (*link && (*link)->word() < word)
+      {
+        link = &(*link)->next;
+      }
+      FoldedSpelling *s = *link;
+      if (!s || s->word() != word)
+      {
+        s = new (arena_.allocate(sizeof(FoldedSpelling) + word.size())) FoldedSpelling{};
+        std::memcpy(s + 1, word.data(), word.size());
+        s->size = static_cast<std::uint32_t>(word.size());
+        s->next = *link;
+        *link = s;
+        ++size_;
+      }
+
+      s->frequency = detail::saturating_add(s->frequency, weight);
+
+      const std::uint64_t f = s->frequency;
+      FoldedNode *n = root_;
+      n->max_frequency = std::max(n->max_frequency, f);
+      detail::fold_each(word, [&](char c)
+                        {
+        n = n->children.find(c);
+        n->max_frequency = std::max(n->max_frequency, f);
+        return true; });
+    }
+
+    /**
+     * @brief Check if some spelling folds to the same key as @p word.
+     */
+    bool contains(std::string_view word) const
+    {
+      detail::ScopedOperation measure(Operation::contains);
+      LockGuard lock(*this);
+      const FoldedNode *node = locate(word);
+      return node && node->spellings;
+    }
+
+    /**
+     * @brief Every spelling of @p word's folded key, in byte order.
+     */
+    std::vector<std::string> spellings(std::string_view word) const
+    {
+      detail::ScopedOperation measure(Operation::contains);
+      LockGuard lock(*this);
+      std::vector<std::string> out;
+      const FoldedNode *node = locate(word);
+      for (const FoldedSpelling *s = node ? node->spellings : nullptr; s; s = s->next)
+      {
+        out.emplace_back(s->word());
+      }
+      return out;
+    }
+
+    /**
+     * @brief Spellings of the words whose folded key starts with the folded @p prefix.
+     * @param limit Max number of results. If 0, returns all matches.
+     */
+    std::vector<std::string> suggest(std::string_view prefix, std::size_t limit = 0) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      suggest(prefix, limit, ctx, [&out](std::string_view word)
+              { out.emplace_back(word); });
+      return out;
+    }
+
+    /**
+     * @brief Visit suggestions using the buffers of @p ctx. A visitor may return false to stop.
+     * @return Number of spellings visited.
+     */
+    template <typename Visitor>
+    std::size_t suggest(std::string_view prefix, std::size_t limit, QueryContext &ctx, Visitor &&visit) const
+    {
+      detail::ScopedOperation measure(Operation::suggest);
+      LockGuard lock(*this);
+
+      const FoldedNode *start = locate(prefix);
+      if (!start)
+      {
+        return 0;
+      }
+
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      sc.stack.clear();
+      sc.stack.push_back(detail::Frame{reinterpret_cast<std::uintptr_t>(start), 0, 0});
+
+      std::size_t count = 0;
+      while (!sc.stack.empty())
+      {
+        const auto *node = reinterpret_cast<const FoldedNode *>(sc.stack.back().node);
+        sc.stack.pop_back();
+        detail::count_nodes(1);
+
+        for (const FoldedSpelling *s = node->spellings; s; s = s->next)
+        {
+          ++count;
+          if (!detail::emit(visit, s->word()) || (limit != 0 && count >= limit))
+          {
+            return count;
+          }
+        }
+
+        const std::size_t mark = sc.stack.size();
+        for (const auto &kv : node->children)
+        {
+          sc.stack.push_back(detail::Frame{reinterpret_cast<std::uintptr_t>(kv.second), 0, 0});
+        }
+        std::reverse(sc.stack.begin() + static_cast<std::ptrdiff_t>(mark), sc.stack.end());
+      }
+      return count;
+    }
+
+    /**
+     * @brief The @p k most frequent spellings under the folded @p prefix.
+     *
+     * Best-first over the cached subtree max frequency, as Trie::suggest_top().
+     * Ties go to the smaller folded key, then the smaller spelling.
+     * @param k Max number of results. If 0, returns all matches by frequency.
+     */
+    std::vector<std::string> suggest_top(std::string_view prefix, std::size_t k) const
+    {
+      detail::ScopedOperation measure(Operation::suggest_top);
+      LockGuard lock(*this);
+
+      const FoldedNode *start = locate(prefix);
+      if (!start)
+      {
+        return {};
+      }
+
+      struct Entry final
+      {
+        std::uint64_t bound;
+        const FoldedNode *node;
+        const FoldedSpelling *spelling;
+        std::string key;
+      };
+
+      const auto worse = [](const Entry &a, const Entry &b)
+      {
+        if (a.bound != b.bound)
+          return a.bound < b.bound;
+        if (a.key != b.key)
+          return a.key > b.key;
+        if (!a.spelling || !b.spelling)
+          return a.spelling != nullptr;
+        return a.spelling->word() > b.spelling->word();
+      };
+
+      std::priority_queue<Entry, std::vector<Entry>, decltype(worse)> frontier(worse);
+      frontier.push(Entry{start->max_frequency, start, nullptr, fold(prefix)});
+
+      std::vector<std::string> out;
+      while (!frontier.empty() && (k == 0 || out.size() < k))
+      {
+        Entry top = frontier.top();
+        frontier.pop();
+
+        if (top.spelling)
+        {
+          out.emplace_back(top.spelling->word());
+          continue;
+        }
+
+        detail::count_nodes(1);
+        for (const FoldedSpelling *s = top.node->spellings; s; s = s->next)
+        {
+          frontier.push(Entry{s->frequency, nullptr, s, top.key});
+        }
+        for (const auto &kv : top.node->children)
+        {
+          std::string key = top.key;
+          key.push_back(kv.first);
+          frontier.push(Entry{kv.second->max_frequency, kv.second, nullptr, std::move(key)});
+        }
+      }
+      return out;
+    }
+
+    /**
+     * @brief Number of distinct spellings.
+     */
+    std::size_t size() const
+    {
+      LockGuard lock(*this);
+      return size_;
+    }
+
+    /**
+     * @brief Node counts, bytes by category, fan-out and depth histograms (see Trie::stats()).
+     *
+     * Terminals count folded keys. payload_bytes counts the stored spellings.
+     */
+    TrieStats stats() const
+    {
+      LockGuard lock(*this);
+      TrieStats s;
+      std::vector<std::pair<const FoldedNode *, std::size_t>> stack{{root_, 0}};
+      while (!stack.empty())
+      {
+        const auto [node, depth] = stack.back();
+        stack.pop_back();
+        detail::record_node(s, *node, depth, node->spellings != nullptr);
+        for (const FoldedSpelling *sp = node->spellings; sp; sp = sp->next)
+        {
+          s.payload_bytes += sizeof(FoldedSpelling) + sp->size;
+        }
+        for (const auto &kv : node->children)
+        {
+          stack.emplace_back(kv.second, depth + 1);
+        }
+      }
+      s.reserved_bytes = arena_.reserved_bytes();
+      return s;
+    }
+
+  private:
+    class LockGuard final
+    {
+    public:
+      explicit LockGuard(const FoldedTrie &t)
+          : t_(t)
+      {
+        detail::LockWait wait(t_.thread_safe_);
+        if (t_.thread_safe_)
+        {
+          t_.mtx_.lock();
+        }
+      }
+
+      ~LockGuard()
+      {
+        if (t_.thread_safe_)
+        {
+          t_.mtx_.unlock();
+        }
+      }
+
+      LockGuard(const LockGuard &) = delete;
+      LockGuard &operator=(const LockGuard &) = delete;
+
+    private:
+      const FoldedTrie &t_;
+    };
+
+    /**
+     * @brief Node of the folded @p key, or nullptr.
+     */
+    const FoldedNode *locate(std::string_view key) const
+    {
+      const FoldedNode *node = root_;
+      detail::fold_each(key, [&node](char c)
+                        {
+        detail::count_nodes(1);
+        node = node->children.find(c);
+        return node != nullptr; });
+      return node;
+    }
+
+    detail::Arena arena_;
+    FoldedNode *root_;
+    std::size_t size_{0};
+    bool thread_safe_{false};
+    mutable std::mutex mtx_;
+  };
+
+} // namespace trie
+
+#endif // TRIE_FOLDED_TRIE_HPP
@@ -0,0 +1,256 @@
+/**
+ * @file instrumentation.hpp
+ * @brief Optional per-operation latency and work counters.
+ *
+ * Notes:
+ * - Compiled in only when TRIE_ENABLE_INSTRUMENTATION is defined to a non-zero
+ *   value (CMake: -DTRIE_ENABLE_INSTRUMENTATION=ON). Otherwise every hook is an
+ *   empty inline function and every guard an empty object, so the hot paths
+ *   compile to the same code as without the hooks.
+ * - Use the same setting in every translation unit that includes a trie
+ *   header. Mixing them breaks the one-definition rule.
+ * - Work counters are thread-local. An operation adds what it did to the
+ *   calling thread's totals and, if a sink is installed, reports it to the
+ *   sink on the same thread once its locks are released.
+ */
+
+#ifndef TRIE_INSTRUMENTATION_HPP
+#define TRIE_INSTRUMENTATION_HPP
+
+#ifndef TRIE_ENABLE_INSTRUMENTATION
+#define TRIE_ENABLE_INSTRUMENTATION 0
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+#if TRIE_ENABLE_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace trie
+{
+  inline constexpr bool instrumentation_enabled = TRIE_ENABLE_INSTRUMENTATION != 0;
+
+  /**
+   * @brief Public operations that report counters.
+   */
+  enum class Operation : std::uint8_t
+  {
+    insert,
+    erase,
+    contains,
+    suggest,
+    suggest_top,
+    search_ranked,
+    search_fuzzy,
+  };
+
+  inline constexpr std::size_t operation_count = 7;
+
+  /**
+   * @brief Work done by one operation, or summed over several.
+   */
+  struct OperationCounters final
+  {
+    std::uint64_t calls{0};
+    std::uint64_t latency_ns{0};
+    /// Nodes reached by a walk or a key lookup.
+    std::uint64_t nodes_visited{0};
+    /// Edit-distance matrix cells evaluated, bit-parallel or not.
+    std::uint64_t dp_cells{0};
+    /// Words offered to the ranked candidate buffer.
+    std::uint64_t candidates_scored{0};
+    /// Time spent acquiring locks, epoch pins included.
+    std::uint64_t lock_wait_ns{0};
+
+    OperationCounters &operator+=(const OperationCounters &other) noexcept
+    {
+      calls += other.calls;
+      latency_ns += other.latency_ns;
+      nodes_visited += other.nodes_visited;
+      dp_cells += other.dp_cells;
+      candidates_scored += other.candidates_scored;
+      lock_wait_ns += other.lock_wait_ns;
+      return *this;
+    }
+  };
+
+  /**
+   * @brief Receiver of per-operation samples, e.g. an adapter to a metrics pipeline.
+   */
+  class InstrumentationSink
+  {
+  public:
+    virtual ~InstrumentationSink() = default;
+
+    /**
+     * @brief Called on the thread that ran @p op, after its locks are released.
+     *
+     * @p sample.calls is 1. Must be thread-safe: operations on different
+     * threads report concurrently.
+     */
+    virtual void record(Operation op, const OperationCounters &sample) noexcept = 0;
+  };
+
+  namespace detail
+  {
+#if TRIE_ENABLE_INSTRUMENTATION
+    struct ThreadCounters final
+    {
+      /// Running work counters. Operations report their difference.
+      OperationCounters work{};
+      OperationCounters totals[operation_count]{};
+      std::uint32_t depth{0};
+    };
+
+    inline thread_local ThreadCounters thread_state{};
+    inline std::atomic<InstrumentationSink *> instrumentation_sink{nullptr};
+
+    inline std::uint64_t now_ns() noexcept
+    {
+      return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            std::chrono::steady_clock::now().time_since_epoch())
+                                            .count());
+    }
+
+    inline void count_nodes(std::size_t n) noexcept { thread_state.work.nodes_visited += n; }
+    inline void count_dp_cells(std::size_t n) noexcept { thread_state.work.dp_cells += n; }
+    inline void count_scored() noexcept { ++thread_state.work.candidates_scored; }
+
+    /**
+     * @brief Measures one public operation. Nested operations count toward the outermost.
+     */
+    class ScopedOperation final
+    {
+    public:
+      explicit ScopedOperation(Operation op) noexcept
+          : op_(op),
+            outer_(thread_state.depth++ == 0)
+      {
+        if (outer_)
+        {
+          start_ = thread_state.work;
+          begin_ns_ = now_ns();
+        }
+      }
+
+      ~ScopedOperation()
+      {
+        ThreadCounters &t = thread_state;
+        --t.depth;
+        if (!outer_)
+        {
+          return;
+        }
+
+        OperationCounters sample;
+        sample.calls = 1;
+        sample.latency_ns = now_ns() - begin_ns_;
+        sample.nodes_visited = t.work.nodes_visited - start_.nodes_visited;
+        sample.dp_cells = t.work.dp_cells - start_.dp_cells;
+        sample.candidates_scored = t.work.candidates_scored - start_.candidates_scored;
+        sample.lock_wait_ns = t.work.lock_wait_ns - start_.lock_wait_ns;
+
+        t.totals[static_cast<std::size_t>(op_)] += sample;
+        if (InstrumentationSink *sink = instrumentation_sink.load(std::memory_order_acquire))
+        {
+          sink->record(op_, sample);
+        }
+      }
+
+      ScopedOperation(const ScopedOperation &) = delete;
+      ScopedOperation &operator=(const ScopedOperation &) = delete;
+
+    private:
+      Operation op_;
+      bool outer_;
+      OperationCounters start_{};
+      std::uint64_t begin_ns_{0};
+    };
+
+    /**
+     * @brief Adds the time from construction to destruction to the lock wait counter.
+     */
+    class LockWait final
+    {
+    public:
+      explicit LockWait(bool active) noexcept
+          : begin_ns_(active ? now_ns() : 0)
+      {
+      }
+
+      ~LockWait()
+      {
+        if (begin_ns_ != 0)
+        {
+          thread_state.work.lock_wait_ns += now_ns() - begin_ns_;
+        }
+      }
+
+      LockWait(const LockWait &) = delete;
+      LockWait &operator=(const LockWait &) = delete;
+
+    private:
+      std::uint64_t begin_ns_;
+    };
+#else
+    inline void count_nodes(std::size_t) noexcept {}
+    inline void count_dp_cells(std::size_t) noexcept {}
+    inline void count_scored() noexcept {}
+
+    class ScopedOperation final
+    {
+    public:
+      explicit ScopedOperation(Operation) noexcept {}
+    };
+
+    class LockWait final
+    {
+    public:
+      explicit LockWait(bool) noexcept {}
+    };
+#endif
+  } // namespace detail
+
+  /**
+   * @brief Install @p sink for every thread, or remove it with nullptr. No-op when disabled.
+   *
+   * The sink must outlive every operation that may still report to it.
+   */
+  inline void set_instrumentation_sink([[maybe_unused]] InstrumentationSink *sink) noexcept
+  {
+#if TRIE_ENABLE_INSTRUMENTATION
+    detail::instrumentation_sink.store(sink, std::memory_order_release);
+#endif
+  }
+
+  /**
+   * @brief Totals of @p op on the calling thread since start or the last reset. Zero when disabled.
+   */
+  inline OperationCounters thread_counters([[maybe_unused]] Operation op) noexcept
+  {
+#if TRIE_ENABLE_INSTRUMENTATION
+    return detail::thread_state.totals[static_cast<std::size_t>(op)];
+#else
+    return {};
+#endif
+  }
+
+  /**
+   * @brief Zero the calling thread's totals.
+   */
+  inline void reset_thread_counters() noexcept
+  {
+#if TRIE_ENABLE_INSTRUMENTATION
+    for (OperationCounters &c : detail::thread_state.totals)
+    {
+      c = OperationCounters{};
+    }
+#endif
+  }
+
+} // namespace trie
+
+#endif // TRIE_INSTRUMENTATION_HPP
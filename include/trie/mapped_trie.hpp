@@ -0,0 +1,202 @@
+/**
+ * @file mapped_trie.hpp
+ * @brief Memory-mapped, read-only trie over a flat image file.
+ *
+ * Notes:
+ * - Opening maps the file read-only and checks its header. Nothing is parsed or
+ *   copied, so startup cost does not depend on dictionary size.
+ * - Pages are shared between every process that maps the same file.
+ * - Produce files with Trie::save().
+ */
+
+#ifndef TRIE_MAPPED_TRIE_HPP
+#define TRIE_MAPPED_TRIE_HPP
+
+#include <trie/flat_trie.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace trie
+{
+  namespace detail
+  {
+    /**
+     * @brief Read-only mapping of a whole file. Move-only.
+     */
+    class FileMapping
+    {
+    public:
+      FileMapping() = default;
+
+      /**
+       * @brief Map @p path. Throws std::system_error on failure.
+       */
+      explicit FileMapping(const std::string &path)
+      {
+#if defined(_WIN32)
+        HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+          throw_last_error("trie: cannot open " + path);
+        }
+
+        LARGE_INTEGER size{};
+        if (!::GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+          ::CloseHandle(file);
+          throw std::system_error(std::make_error_code(std::errc::invalid_argument), "trie: empty or unreadable " + path);
+        }
+
+        HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        ::CloseHandle(file);
+        if (!mapping)
+        {
+          throw_last_error("trie: cannot map " + path);
+        }
+
+        void *data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        ::CloseHandle(mapping);
+        if (!data)
+        {
+          throw_last_error("trie: cannot map " + path);
+        }
+
+        data_ = static_cast<const std::byte *>(data);
+        size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+          throw_last_error("trie: cannot open " + path);
+        }
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+        {
+          ::close(fd);
+          throw std::system_error(std::make_error_code(std::errc::invalid_argument), "trie: empty or unreadable " + path);
+        }
+
+        void *data = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+          throw_last_error("trie: cannot map " + path);
+        }
+
+        data_ = static_cast<const std::byte *>(data);
+        size_ = static_cast<std::size_t>(st.st_size);
+#endif
+      }
+
+      ~FileMapping()
+      {
+        unmap();
+      }
+
+      FileMapping(FileMapping &&other) noexcept
+          : data_(std::exchange(other.data_, nullptr)),
+            size_(std::exchange(other.size_, 0))
+      {
+      }
+
+      FileMapping &operator=(FileMapping &&other) noexcept
+      {
+        if (this != &other)
+        {
+          unmap();
+          data_ = std::exchange(other.data_, nullptr);
+          size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+      }
+
+      FileMapping(const FileMapping &) = delete;
+      FileMapping &operator=(const FileMapping &) = delete;
+
+      std::span<const std::byte> bytes() const noexcept { return {data_, size_}; }
+
+    private:
+      [[noreturn]] static void throw_last_error(const std::string &what)
+      {
+#if defined(_WIN32)
+        throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(), what);
+#else
+        throw std::system_error(errno, std::generic_category(), what);
+#endif
+      }
+
+      void unmap() noexcept
+      {
+        if (!data_)
+        {
+          return;
+        }
+#if defined(_WIN32)
+        ::UnmapViewOfFile(data_);
+#else
+        ::munmap(const_cast<std::byte *>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+      }
+
+      const std::byte *data_{nullptr};
+      std::size_t size_{0};
+    };
+  } // namespace detail
+
+  /**
+   * @brief Read-only trie answering queries straight from a mapped file.
+   *
+   * Has the whole FlatTrieView query API: contains(), suggest(), suggest_top(),
+   * search_ranked() and search_fuzzy(). Move-only.
+   *
+   * Thread safety:
+   * - Queries are const and lock-free.
+   */
+  class MappedTrie final : private detail::FileMapping, public FlatTrieView
+  {
+  public:
+    /**
+     * @brief Map @p path.
+     *
+     * Throws std::system_error if the file cannot be mapped and
+     * std::invalid_argument if it is not a flat trie image.
+     */
+    explicit MappedTrie(const std::string &path)
+        : detail::FileMapping(path),
+          FlatTrieView(bytes())
+    {
+    }
+
+    MappedTrie(MappedTrie &&) noexcept = default;
+    MappedTrie &operator=(MappedTrie &&) noexcept = default;
+
+    /**
+     * @brief The mapped image bytes.
+     */
+    std::span<const std::byte> image() const noexcept { return bytes(); }
+  };
+
+} // namespace trie
+
+#endif // TRIE_MAPPED_TRIE_HPP
@@ -0,0 +1,213 @@
+/**
+ * @file query_cache.hpp
+ * @brief Bounded result cache for repeated suggest and ranked queries.
+ *
+ * Notes:
+ * - Entries are keyed by (query kind, query, limit, max distance) and spread
+ *   over independently locked LRU shards, so concurrent lookups of different
+ *   queries rarely contend.
+ * - Every entry records the source's generation() from before it was
+ *   computed. A lookup that sees a newer generation recomputes the entry, so
+ *   writers never touch the cache and a cached answer never outlives the
+ *   write that changed it.
+ */
+
+#ifndef TRIE_QUERY_CACHE_HPP
+#define TRIE_QUERY_CACHE_HPP
+
+#include <trie/trie.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace trie
+{
+  /**
+   * @brief Size-bounded, sharded LRU cache in front of a Trie (or ShardedTrie).
+   *
+   * Features:
+   * - suggest(prefix, limit)
+   * - search_ranked(query, limit)
+   * - search_fuzzy(query, max_distance, limit)
+   * - hits(), misses(), size(), clear()
+   *
+   * Thread safety:
+   * - Safe to use from several threads if the source itself is.
+   * - The source must outlive the cache.
+   */
+  template <typename Source = Trie>
+  class QueryCache final
+  {
+  public:
+    /**
+     * @brief Cache results of @p source.
+     * @param capacity Max number of cached results in total, split across shards.
+     * @param shards Number of independently locked shards. Capped at @p capacity,
+     *        so that every shard can hold at least one result.
+     */
+    explicit QueryCache(const Source &source, std::size_t capacity = 4096, std::size_t shards = 16)
+        : source_(source),
+          shards_(std::max<std::size_t>(1, std::min(shards, capacity)))
+    {
+      // The first capacity % n shards take one extra entry, so the total is capacity exactly.
+      const std::size_t n = shards_.size();
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        shards_[i].capacity = capacity / n + (i < capacity % n ? 1 : 0);
+      }
+    }
+
+    QueryCache(const QueryCache &) = delete;
+    QueryCache &operator=(const QueryCache &) = delete;
+
+    std::vector<std::string> suggest(std::string_view prefix, std::size_t limit = 0)
+    {
+      return lookup(Kind::suggest, prefix, limit, 0, [&]
+                    { return source_.suggest(prefix, limit); });
+    }
+
+    std::vector<std::string> search_ranked(std::string_view query, std::size_t limit = 10)
+    {
+      return lookup(Kind::ranked, query, limit, 0, [&]
+                    { return source_.search_ranked(query, limit); });
+    }
+
+    std::vector<std::string> search_fuzzy(std::string_view query, std::size_t max_distance, std::size_t limit = 10)
+    {
+      return lookup(Kind::fuzzy, query, limit, max_distance, [&]
+                    { return source_.search_fuzzy(query, max_distance, limit); });
+    }
+
+    std::uint64_t hits() const noexcept { return hits_.load(std::memory_order_relaxed); }
+    std::uint64_t misses() const noexcept { return misses_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Number of cached results, current or stale.
+     */
+    std::size_t size() const
+    {
+      std::size_t n = 0;
+      for (const Shard &s : shards_)
+      {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        n += s.order.size();
+      }
+      return n;
+    }
+
+    void clear()
+    {
+      for (Shard &s : shards_)
+      {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.index.clear();
+        s.order.clear();
+      }
+    }
+
+  private:
+    enum class Kind : char
+    {
+      suggest = 's',
+      ranked = 'r',
+      fuzzy = 'f',
+    };
+
+    struct Entry final
+    {
+      std::string key;
+      std::uint64_t generation;
+      std::vector<std::string> result;
+    };
+
+    /// One LRU list, most recently used first, and its index by key.
+    struct Shard final
+    {
+      mutable std::mutex mtx;
+      std::list<Entry> order;
+      std::unordered_map<std::string_view, typename std::list<Entry>::iterator> index;
+      std::size_t capacity{0};
+    };
+
+    static std::string make_key(Kind kind, std::string_view query, std::size_t limit, std::size_t max_distance)
+    {
+      const std::uint64_t fields[2] = {static_cast<std::uint64_t>(limit), static_cast<std::uint64_t>(max_distance)};
+      std::string key(1 + sizeof(fields) + query.size(), '\0');
+      key[0] = static_cast<char>(kind);
+      std::memcpy(key.data() + 1, fields, sizeof(fields));
+      std::memcpy(key.data() + 1 + sizeof(fields), query.data(), query.size());
+      return key;
+    }
+
+    template <typename Compute>
+    std::vector<std::string> lookup(Kind kind, std::string_view query, std::size_t limit,
+                                    std::size_t max_distance, Compute &&compute)
+    {
+      std::string key = make_key(kind, query, limit, max_distance);
+      Shard &s = shards_[std::hash<std::string_view>{}(key) % shards_.size()];
+
+      // Read before computing: a write that races with the query leaves the
+      // entry tagged older than the trie, so the next lookup recomputes it.
+      const std::uint64_t generation = source_.generation();
+      {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        const auto it = s.index.find(key);
+        if (it != s.index.end() && it->second->generation == generation)
+        {
+          s.order.splice(s.order.begin(), s.order, it->second);
+          hits_.fetch_add(1, std::memory_order_relaxed);
+          return it->second->result;
+        }
+      }
+
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      std::vector<std::string> result = compute();
+      if (s.capacity == 0)
+      {
+        return result;
+      }
+
+      std::lock_guard<std::mutex> lock(s.mtx);
+      const auto it = s.index.find(key);
+      if (it != s.index.end())
+      {
+        if (it->second->generation <= generation)
+        {
+          it->second->generation = generation;
+          it->second->result = result;
+        }
+        s.order.splice(s.order.begin(), s.order, it->second);
+        return result;
+      }
+
+      if (s.order.size() == s.capacity)
+      {
+        s.index.erase(s.order.back().key);
+        s.order.pop_back();
+      }
+      s.order.push_front(Entry{std::move(key), generation, result});
+      s.index.emplace(s.order.front().key, s.order.begin());
+      return result;
+    }
+
+    const Source &source_;
+    std::vector<Shard> shards_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+  };
+
+} // namespace trie
+
+#endif // TRIE_QUERY_CACHE_HPP
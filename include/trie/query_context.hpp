@@ -0,0 +1,106 @@
+/**
+ * @file query_context.hpp
+ * @brief Reusable scratch buffers shared by the trie query engines.
+ */
+
+#ifndef TRIE_QUERY_CONTEXT_HPP
+#define TRIE_QUERY_CONTEXT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trie
+{
+  class QueryContext;
+
+  namespace detail
+  {
+    struct ScoredWord final
+    {
+      std::string word;
+      double score{0.0};
+    };
+
+    /**
+     * @brief Pending node of an explicit-stack depth-first walk.
+     *
+     * Popping a frame cuts the walk's key back to key_size and appends the
+     * node's edge label, so one key buffer serves the whole walk. Walks push a
+     * node's children in reverse, so they pop in ascending byte order.
+     */
+    struct Frame final
+    {
+      /// Node pointer or index, as the engine stores nodes.
+      std::uintptr_t node;
+      /// Key length before this node's edge label.
+      std::uint32_t key_size;
+      /// Engine data: the edge byte, a DAWG word rank, ...
+      std::uint32_t aux;
+    };
+
+    /**
+     * @brief Buffers a query reuses instead of allocating.
+     */
+    struct QueryScratch final
+    {
+      /// Key of the node being visited.
+      std::string key{};
+      /// Levenshtein DP rows.
+      std::vector<int> rows{};
+      /// Ranked candidates. Only the first scored_size entries are live; the rest
+      /// keep their string capacity for the next query. With a nonzero limit the
+      /// live entries form a heap whose front is the worst kept candidate.
+      std::vector<ScoredWord> scored{};
+      std::size_t scored_size{0};
+      /// Most candidates to keep, or 0 to keep all.
+      std::size_t limit{0};
+      /// Per-byte match masks of the current query for the bit-parallel kernel.
+      /// Empty when the query has not been prepared or is too long.
+      std::vector<std::uint64_t> peq{};
+      /// Pending nodes of the current depth-first walk. Walks never recurse, so
+      /// key length does not bound the call stack.
+      std::vector<Frame> stack{};
+
+      void reset(std::size_t bound = 0) noexcept
+      {
+        key.clear();
+        scored_size = 0;
+        limit = bound;
+        peq.clear();
+      }
+    };
+
+    struct QueryAccess final
+    {
+      static QueryScratch &scratch(QueryContext &ctx) noexcept;
+    };
+  } // namespace detail
+
+  /**
+   * @brief Reusable scratch buffers for allocation-free queries.
+   *
+   * Pass the same context to repeated visitor-style queries. Its buffers grow to
+   * the working size during the first queries; after that a query does not touch
+   * the allocator. A context must not be used by two threads at once.
+   */
+  class QueryContext final
+  {
+  public:
+    QueryContext() = default;
+
+  private:
+    friend struct detail::QueryAccess;
+
+    detail::QueryScratch scratch_{};
+  };
+
+  inline detail::QueryScratch &detail::QueryAccess::scratch(QueryContext &ctx) noexcept
+  {
+    return ctx.scratch_;
+  }
+
+} // namespace trie
+
+#endif // TRIE_QUERY_CONTEXT_HPP
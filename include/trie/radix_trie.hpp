@@ -0,0 +1,524 @@
+/**
+ * @file radix_trie.hpp
+ * @brief Path-compressed (radix) trie with the same queries as trie::Trie.
+ *
+ * Notes:
+ * - Each edge stores a byte span instead of one char, so a chain of single-child
+ *   nodes collapses into one node. Memory and lookup depth scale with the number
+ *   of branching points, not with key length.
+ * - Edge labels live in the arena. A split only re-slices the existing label.
+ * - suggest(), search_ranked() and search_fuzzy() return the same results as Trie.
+ */
+
+#ifndef TRIE_RADIX_TRIE_HPP
+#define TRIE_RADIX_TRIE_HPP
+
+#include <trie/detail/arena.hpp>
+#include <trie/detail/child_map.hpp>
+#include <trie/detail/scoring.hpp>
+#include <trie/instrumentation.hpp>
+#include <trie/query_context.hpp>
+#include <trie/stats.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace trie
+{
+  /**
+   * @brief Radix trie node. The edge from the parent is [label, label + label_size).
+   */
+  struct RadixNode final
+  {
+    detail::ChildMap<RadixNode> children{};
+    const char *label{nullptr};
+    std::uint32_t label_size{0};
+    bool is_terminal{false};
+    std::uint64_t frequency{0};
+
+    std::string_view edge() const noexcept { return {label, label_size}; }
+  };
+
+  static_assert(std::is_trivially_destructible_v<RadixNode>,
+                "radix nodes are released with their arena and never destructed");
+
+  /**
+   * @brief Path-compressed autocomplete trie.
+   *
+   * Features:
+   * - insert(word), insert(word, weight)
+   * - contains(word)
+   * - suggest(prefix, limit)
+   * - search_ranked(query, limit)
+   * - search_fuzzy(query, max_distance, limit)
+   * - stats()
+   *
+   * Thread safety:
+   * - By default, this class is NOT thread-safe.
+   * - Pass thread_safe=true to lock an internal mutex around every operation.
+   */
+  class RadixTrie final
+  {
+  public:
+    /**
+     * @brief Construct an empty radix trie.
+     * @param thread_safe If true, operations lock an internal mutex.
+     * @param resource Upstream memory resource for node chunks.
+     */
+    explicit RadixTrie(bool thread_safe = false,
+                       std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : arena_(resource),
+          root_(arena_.create<RadixNode>()),
+          thread_safe_(thread_safe)
+    {
+    }
+
+    void insert(std::string_view word) { insert(word, 1); }
+
+    /**
+     * @brief Insert a word, or raise its frequency by @p weight, splitting an edge where it diverges.
+     *
+     * Frequencies saturate instead of wrapping, as in Trie.
+     */
+    void insert(std::string_view word, std::uint64_t weight)
+    {
+      detail::ScopedOperation measure(Operation::insert);
+      LockGuard lock(*this);
+
+      RadixNode *node = root_;
+      std::string_view rest = word;
+
+      while (!rest.empty())
+      {
+        detail::count_nodes(1);
+        RadixNode *child = node->children.find(rest.front());
+        if (!child)
+        {
+          RadixNode *leaf = arena_.create<RadixNode>();
+          set_label(leaf, rest);
+          node->children.emplace(rest.front(), leaf, arena_);
+          node = leaf;
+          break;
+        }
+
+        const std::size_t common = common_prefix(child->edge(), rest);
+        if (common < child->label_size)
+        {
+          // Split the edge: node -> mid -> child, mid keeping the shared bytes.
+          RadixNode *mid = arena_.create<RadixNode>();
+          mid->label = child->label;
+          mid->label_size = static_cast<std::uint32_t>(common);
+
+          child->label += common;
+          child->label_size -= static_cast<std::uint32_t>(common);
+
+          mid->children.emplace(child->label[0], child, arena_);
+          node->children.replace(rest.front(), mid);
+          child = mid;
+        }
+
+        node = child;
+        rest.remove_prefix(common);
+      }
+
+      node->is_terminal = true;
+      node->frequency = detail::saturating_add(node->frequency, weight);
+    }
+
+    /**
+     * @brief Check if a word exists in the trie.
+     */
+    bool contains(std::string_view word) const
+    {
+      detail::ScopedOperation measure(Operation::contains);
+      LockGuard lock(*this);
+
+      const RadixNode *node = root_;
+      std::string_view rest = word;
+
+      while (!rest.empty())
+      {
+        detail::count_nodes(1);
+        node = node->children.find(rest.front());
+        if (!node || rest.substr(0, node->label_size) != node->edge())
+        {
+          return false;
+        }
+        rest.remove_prefix(node->label_size);
+      }
+      return node->is_terminal;
+    }
+
+    /**
+     * @brief Return prefix suggestions.
+     * @param prefix Prefix to complete.
+     * @param limit Max number of results. If 0, returns all matches.
+     */
+    std::vector<std::string> suggest(std::string_view prefix, std::size_t limit = 0) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      suggest(prefix, limit, ctx, [&out](std::string_view word)
+              { out.emplace_back(word); });
+      return out;
+    }
+
+    /**
+     * @brief Visit prefix suggestions using the buffers of @p ctx.
+     * @return Number of words visited.
+     */
+    template <typename Visitor>
+    std::size_t suggest(std::string_view prefix, std::size_t limit, QueryContext &ctx, Visitor &&visit) const
+    {
+      detail::ScopedOperation measure(Operation::suggest);
+      LockGuard lock(*this);
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+
+      sc.key.assign(prefix);
+      const RadixNode *node = locate_prefix(sc.key);
+      if (!node)
+      {
+        return 0;
+      }
+
+      std::size_t count = 0;
+      collect_suggestions(node, sc, limit, count, visit);
+      return count;
+    }
+
+    /**
+     * @brief Ranked fuzzy search over every word. Same ranking as Trie::search_ranked().
+     */
+    std::vector<std::string> search_ranked(std::string_view query, std::size_t limit = 10) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      search_ranked(query, limit, ctx, [&out](std::string_view word)
+                    { out.emplace_back(word); });
+      return out;
+    }
+
+    /**
+     * @brief Visit ranked fuzzy search results using the buffers of @p ctx.
+     */
+    template <typename Visitor>
+    std::size_t search_ranked(std::string_view query, std::size_t limit, QueryContext &ctx, Visitor &&visit) const
+    {
+      detail::ScopedOperation measure(Operation::search_ranked);
+      LockGuard lock(*this);
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+
+      sc.reset(limit);
+      detail::prepare_distance(sc, query);
+      collect_scored(root_, sc, query);
+      return detail::emit_ranked(sc, limit, visit);
+    }
+
+    /**
+     * @brief Ranked fuzzy search bounded by an edit distance. Same results as Trie::search_fuzzy().
+     *
+     * Computes one DP row per label byte and prunes an edge as soon as its row
+     * minimum exceeds @p max_distance.
+     */
+    std::vector<std::string> search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit = 10) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      search_fuzzy(query, max_distance, limit, ctx, [&out](std::string_view word)
+                   { out.emplace_back(word); });
+      return out;
+    }
+
+    /**
+     * @brief Visit bounded fuzzy search results using the buffers of @p ctx.
+     */
+    template <typename Visitor>
+    std::size_t search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit,
+        QueryContext &ctx,
+        Visitor &&visit) const
+    {
+      detail::ScopedOperation measure(Operation::search_fuzzy);
+      LockGuard lock(*this);
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+
+      const std::size_t width = query.size() + 1;
+      sc.rows.resize(width);
+      for (std::size_t j = 0; j < width; ++j)
+      {
+        sc.rows[j] = static_cast<int>(j);
+      }
+      sc.reset(limit);
+
+      if (root_->is_terminal && query.size() <= max_distance)
+      {
+        detail::push_scored(sc, detail::score_distance(static_cast<int>(query.size()), 0, root_->frequency));
+      }
+
+      collect_fuzzy(sc, query, detail::distance_bound(max_distance));
+
+      return detail::emit_ranked(sc, limit, visit);
+    }
+
+    /**
+     * @brief Node counts, bytes by category, fan-out and depth histograms (see Trie::stats()).
+     *
+     * payload_bytes counts the edge labels. Depth is in nodes, not bytes.
+     */
+    TrieStats stats() const
+    {
+      LockGuard lock(*this);
+      TrieStats s;
+      std::vector<std::pair<const RadixNode *, std::size_t>> stack{{root_, 0}};
+      while (!stack.empty())
+      {
+        const auto [node, depth] = stack.back();
+        stack.pop_back();
+        detail::record_node(s, *node, depth);
+        s.payload_bytes += node->label_size;
+        for (const auto &kv : node->children)
+        {
+          stack.emplace_back(kv.second, depth + 1);
+        }
+      }
+      s.reserved_bytes = arena_.reserved_bytes();
+      return s;
+    }
+
+  private:
+    class LockGuard final
+    {
+    public:
+      explicit LockGuard(const RadixTrie &t)
+          : t_(t)
+      {
+        detail::LockWait wait(t_.thread_safe_);
+        if (t_.thread_safe_)
+        {
+          t_.mtx_.lock();
+        }
+      }
+
+      ~LockGuard()
+      {
+        if (t_.thread_safe_)
+        {
+          t_.mtx_.unlock();
+        }
+      }
+
+      LockGuard(const LockGuard &) = delete;
+      LockGuard &operator=(const LockGuard &) = delete;
+
+    private:
+      const RadixTrie &t_;
+    };
+
+    static std::size_t common_prefix(std::string_view a, std::string_view b) noexcept
+    {
+      const std::size_t n = std::min(a.size(), b.size());
+      std::size_t i = 0;
+      while (i < n && a[i] == b[i])
+      {
+        ++i;
+      }
+      return i;
+    }
+
+    void set_label(RadixNode *node, std::string_view bytes)
+    {
+      char *label = static_cast<char *>(arena_.allocate(bytes.size()));
+      std::memcpy(label, bytes.data(), bytes.size());
+      node->label = label;
+      node->label_size = static_cast<std::uint32_t>(bytes.size());
+    }
+
+    /**
+     * @brief Find the node whose subtree holds every completion of @p key.
+     *
+     * If the prefix ends inside an edge, the rest of that edge is appended to
+     * @p key so that it names the returned node.
+     */
+    const RadixNode *locate_prefix(std::string &key) const
+    {
+      const RadixNode *node = root_;
+      std::string_view rest = key;
+      std::size_t matched = 0;
+
+      while (!rest.empty())
+      {
+        detail::count_nodes(1);
+        node = node->children.find(rest.front());
+        if (!node)
+        {
+          return nullptr;
+        }
+
+        const std::size_t n = std::min<std::size_t>(rest.size(), node->label_size);
+        if (rest.substr(0, n) != node->edge().substr(0, n))
+        {
+          return nullptr;
+        }
+
+        matched += n;
+        if (n < node->label_size)
+        {
+          key.append(node->label + n, node->label_size - n);
+          return node;
+        }
+        rest = std::string_view(key).substr(matched);
+      }
+      return node;
+    }
+
+    /**
+     * @brief Visit the words below @p start in byte order; sc.key holds its key.
+     *
+     * Iterative preorder walk on sc.stack. sc.key is restored before returning.
+     */
+    template <typename Visitor>
+    static bool collect_suggestions(
+        const RadixNode *start,
+        detail::QueryScratch &sc,
+        std::size_t limit,
+        std::size_t &count,
+        Visitor &visit)
+    {
+      const std::size_t base = sc.key.size();
+      sc.stack.clear();
+      detail::count_nodes(1);
+
+      bool more = true;
+      for (const RadixNode *node = start; node; node = next_frame(sc))
+      {
+        if (node->is_terminal)
+        {
+          ++count;
+          if (!detail::emit(visit, sc.key) || (limit != 0 && count >= limit))
+          {
+            more = false;
+            break;
+          }
+        }
+        push_children(sc, node);
+      }
+
+      sc.key.resize(base);
+      return more;
+    }
+
+    static void collect_scored(const RadixNode *start, detail::QueryScratch &sc, std::string_view query)
+    {
+      const std::size_t base = sc.key.size();
+      sc.stack.clear();
+      detail::count_nodes(1);
+
+      for (const RadixNode *node = start; node; node = next_frame(sc))
+      {
+        if (node->is_terminal)
+        {
+          const int d = detail::levenshtein_distance(query, sc.key, sc);
+          detail::push_scored(sc, detail::score_distance(d, sc.key.size(), node->frequency));
+        }
+        push_children(sc, node);
+      }
+
+      sc.key.resize(base);
+    }
+
+    /**
+     * @brief Bounded fuzzy walk below the root. sc.rows holds the root row and sc.key is empty.
+     *
+     * Extends the DP rows by one row per label byte (rows[k * width] is the row
+     * for key length k) and drops an edge as soon as its row minimum exceeds
+     * @p max_distance.
+     */
+    void collect_fuzzy(detail::QueryScratch &sc, std::string_view query, int max_distance) const
+    {
+      const std::size_t width = query.size() + 1;
+
+      sc.stack.clear();
+      detail::count_nodes(1);
+      push_children(sc, root_);
+      while (const RadixNode *node = next_frame(sc))
+      {
+        const std::size_t first = sc.key.size() - node->label_size;
+
+        int row_min = 0;
+        for (std::size_t k = first; k < sc.key.size() && row_min <= max_distance; ++k)
+        {
+          sc.rows.resize((k + 2) * width);
+          int *row = sc.rows.data() + (k + 1) * width;
+          row_min = detail::levenshtein_step(query, row - width, row, sc.key[k]);
+        }
+        if (row_min > max_distance)
+        {
+          continue;
+        }
+
+        const int d = sc.rows[(sc.key.size() + 1) * width - 1];
+        if (node->is_terminal && d <= max_distance)
+        {
+          detail::push_scored(sc, detail::score_distance(d, sc.key.size(), node->frequency));
+        }
+        push_children(sc, node);
+      }
+
+      sc.key.clear();
+    }
+
+    /**
+     * @brief Queue the children of @p node, keyed after sc.key, to pop in byte order.
+     */
+    static void push_children(detail::QueryScratch &sc, const RadixNode *node)
+    {
+      const std::size_t mark = sc.stack.size();
+      const auto key_size = static_cast<std::uint32_t>(sc.key.size());
+      for (const auto &kv : node->children)
+      {
+        sc.stack.push_back(detail::Frame{reinterpret_cast<std::uintptr_t>(kv.second), key_size, 0});
+      }
+      std::reverse(sc.stack.begin() + static_cast<std::ptrdiff_t>(mark), sc.stack.end());
+    }
+
+    /**
+     * @brief Pop the next node of the walk and set sc.key to its key, or return nullptr.
+     */
+    static const RadixNode *next_frame(detail::QueryScratch &sc)
+    {
+      if (sc.stack.empty())
+      {
+        return nullptr;
+      }
+      const detail::Frame f = sc.stack.back();
+      sc.stack.pop_back();
+      detail::count_nodes(1);
+      const auto *node = reinterpret_cast<const RadixNode *>(f.node);
+      sc.key.resize(f.key_size);
+      sc.key.append(node->label, node->label_size);
+      return node;
+    }
+
+    detail::Arena arena_;
+    RadixNode *root_;
+    bool thread_safe_{false};
+    mutable std::mutex mtx_;
+  };
+
+} // namespace trie
+
+#endif // TRIE_RADIX_TRIE_HPP
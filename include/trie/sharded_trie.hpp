@@ -0,0 +1,364 @@
+/**
+ * @file sharded_trie.hpp
+ * @brief Trie split into independently locked shards for concurrent writers.
+ *
+ * Notes:
+ * - Each shard is a trie::Trie with its own lock, so inserts into different
+ *   shards run in parallel instead of queuing on one mutex.
+ * - Partition::first_byte keeps every word starting with a given byte in one
+ *   shard (byte modulo shard count). A non-empty prefix query then touches a
+ *   single shard; an empty prefix fans out.
+ * - Partition::hash spreads words by their hash. Point operations stay on one
+ *   shard; every prefix query fans out.
+ * - Fan-out queries merge per-shard results into exactly what one Trie holding
+ *   all the words returns. They lock one shard at a time (suggest_top() locks
+ *   all of them together), so they are not atomic across concurrent writes to
+ *   other shards.
+ */
+
+#ifndef TRIE_SHARDED_TRIE_HPP
+#define TRIE_SHARDED_TRIE_HPP
+
+#include <trie/detail/parallel.hpp>
+#include <trie/detail/scoring.hpp>
+#include <trie/detail/sorted_input.hpp>
+#include <trie/instrumentation.hpp>
+#include <trie/trie.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trie
+{
+  /**
+   * @brief How ShardedTrie assigns words to shards.
+   */
+  enum class Partition
+  {
+    /// By first byte. Prefix queries with a non-empty prefix hit one shard.
+    first_byte,
+    /// By hash of the whole word. Best balance; prefix queries fan out.
+    hash,
+  };
+
+  /**
+   * @brief A set of Trie shards behind the Trie interface.
+   *
+   * Features:
+   * - insert(word), insert(word, weight), merge_counts(counts)
+   * - erase(word), add_frequency(word, delta)
+   * - contains(word), frequency(word)
+   * - suggest(prefix, limit), suggest_after(prefix, last_key, limit), suggest_top(prefix, k)
+   * - search_ranked(query, limit), search_fuzzy(query, max_distance, limit)
+   * - stats(), shrink_to_fit(), freeze()
+   *
+   * Thread safety:
+   * - Follows the Concurrency mode given to the shards. With any mode other
+   *   than Concurrency::none, all operations may be called concurrently.
+   */
+  class ShardedTrie final
+  {
+  public:
+    /**
+     * @brief Construct an empty sharded trie.
+     * @param shards Number of shards (0 = one per core).
+     * @param concurrency Locking strategy of every shard.
+     * @param partition Word-to-shard assignment.
+     * @param resource Upstream memory resource for node chunks.
+     */
+    explicit ShardedTrie(std::size_t shards = 0,
+                         Concurrency concurrency = Concurrency::shared,
+                         Partition partition = Partition::first_byte,
+                         std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : partition_(partition)
+    {
+      shards = detail::worker_count(shards);
+      shards_.reserve(shards);
+      for (std::size_t i = 0; i < shards; ++i)
+      {
+        shards_.push_back(std::make_unique<Trie>(concurrency, resource));
+      }
+    }
+
+    std::size_t shard_count() const noexcept { return shards_.size(); }
+
+    /**
+     * @brief Shard @p i, for per-shard maintenance such as to_flat().
+     */
+    const Trie &shard(std::size_t i) const noexcept { return *shards_[i]; }
+
+    void insert(std::string_view word) { shard_of(word).insert(word); }
+
+    void insert(std::string_view word, Frequency weight) { shard_of(word).insert(word, weight); }
+
+    bool erase(std::string_view word) { return shard_of(word).erase(word); }
+
+    Frequency add_frequency(std::string_view word, std::int64_t delta)
+    {
+      return shard_of(word).add_frequency(word, delta);
+    }
+
+    bool contains(std::string_view word) const { return shard_of(word).contains(word); }
+
+    Frequency frequency(std::string_view word) const { return shard_of(word).frequency(word); }
+
+    /**
+     * @brief Sum of the shards' mutation counters. Grows with every committed change.
+     */
+    std::uint64_t generation() const noexcept
+    {
+      std::uint64_t sum = 0;
+      for (const auto &s : shards_)
+      {
+        sum += s->generation();
+      }
+      return sum;
+    }
+
+    /**
+     * @brief Stats of every shard, summed.
+     */
+    TrieStats stats() const
+    {
+      TrieStats total;
+      for (const auto &s : shards_)
+      {
+        total += s->stats();
+      }
+      return total;
+    }
+
+    /**
+     * @brief Compact every shard, one at a time, as Trie::shrink_to_fit().
+     */
+    void shrink_to_fit()
+    {
+      for (const auto &s : shards_)
+      {
+        s->shrink_to_fit();
+      }
+    }
+
+    /**
+     * @brief Freeze every shard, one at a time, as Trie::freeze().
+     *
+     * Single-shard reads and per-shard suggest() use the frozen images; fan-out
+     * suggest_top(), search_ranked() and search_fuzzy() still walk the nodes.
+     */
+    void freeze()
+    {
+      for (const auto &s : shards_)
+      {
+        s->freeze();
+      }
+    }
+
+    /**
+     * @brief Split a batch of words or (word, count) pairs by shard and merge each part.
+     *
+     * Throws std::invalid_argument on a negative count, before any change.
+     */
+    template <typename Range>
+    void merge_counts(const Range &counts)
+    {
+      std::vector<std::vector<detail::SortedEntry>> parts(shards_.size());
+      std::deque<std::string> owned;
+      for (const auto &element : counts)
+      {
+        detail::SortedEntry e = detail::sorted_entry(element);
+        if constexpr (!detail::yields_lvalues_v<Range>)
+        {
+          e.word = owned.emplace_back(e.word);
+        }
+        parts[index_of(e.word)].push_back(e);
+      }
+
+      for (std::size_t i = 0; i < parts.size(); ++i)
+      {
+        if (!parts[i].empty())
+        {
+          shards_[i]->merge_counts(parts[i]);
+        }
+      }
+    }
+
+    /**
+     * @brief Words starting with @p prefix in byte order, as Trie::suggest().
+     */
+    std::vector<std::string> suggest(std::string_view prefix, std::size_t limit = 0) const
+    {
+      detail::ScopedOperation measure(Operation::suggest);
+      if (routes(prefix))
+      {
+        return shard_of(prefix).suggest(prefix, limit);
+      }
+
+      return merge_pages([&](const Trie &s)
+                         { return s.suggest(prefix, limit); },
+                         limit);
+    }
+
+    /**
+     * @brief One page of suggestions after @p last_key, as Trie::suggest_after().
+     */
+    std::vector<std::string> suggest_after(std::string_view prefix, std::string_view last_key, std::size_t limit) const
+    {
+      detail::ScopedOperation measure(Operation::suggest);
+      if (routes(prefix))
+      {
+        return shard_of(prefix).suggest_after(prefix, last_key, limit);
+      }
+      return merge_pages([&](const Trie &s)
+                         { return s.suggest_after(prefix, last_key, limit); },
+                         limit);
+    }
+
+    /**
+     * @brief The @p k most frequent completions of @p prefix, as Trie::suggest_top().
+     */
+    std::vector<std::string> suggest_top(std::string_view prefix, std::size_t k) const
+    {
+      detail::ScopedOperation measure(Operation::suggest_top);
+      if (routes(prefix))
+      {
+        return shard_of(prefix).suggest_top(prefix, k);
+      }
+
+      // Shards hold disjoint words, so one best-first pass over all their
+      // prefix nodes yields the global order.
+      std::vector<std::unique_ptr<Trie::ReadLock>> locks;
+      std::vector<Trie::Seed> seeds;
+      locks.reserve(shards_.size());
+      for (const auto &s : shards_)
+      {
+        locks.push_back(std::make_unique<Trie::ReadLock>(*s));
+        if (const TrieNode *node = find(locks.back()->root(), prefix))
+        {
+          seeds.push_back(Trie::Seed{node, prefix, 0});
+        }
+      }
+      return Trie::best_completions(seeds, k);
+    }
+
+    /**
+     * @brief Ranked search over every shard, as Trie::search_ranked().
+     *
+     * All shards feed one bounded candidate buffer, so the result is the
+     * global top @p limit by score.
+     */
+    std::vector<std::string> search_ranked(std::string_view query, std::size_t limit = 10) const
+    {
+      detail::ScopedOperation measure(Operation::search_ranked);
+      QueryContext ctx;
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      sc.reset(limit);
+      detail::prepare_distance(sc, query);
+
+      for (const auto &s : shards_)
+      {
+        Trie::ReadLock lock(*s);
+        Trie::collect_scored(lock.root(), sc, query);
+      }
+      return ranked(sc, limit);
+    }
+
+    /**
+     * @brief Bounded fuzzy search over every shard, as Trie::search_fuzzy().
+     */
+    std::vector<std::string> search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit = 10) const
+    {
+      detail::ScopedOperation measure(Operation::search_fuzzy);
+      QueryContext ctx;
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      sc.reset(limit);
+
+      for (const auto &s : shards_)
+      {
+        Trie::ReadLock lock(*s);
+        Trie::collect_fuzzy_from_root(lock.root(), sc, query, max_distance);
+      }
+      return ranked(sc, limit);
+    }
+
+  private:
+    bool routes(std::string_view prefix) const noexcept
+    {
+      return partition_ == Partition::first_byte && !prefix.empty();
+    }
+
+    std::size_t index_of(std::string_view word) const noexcept
+    {
+      if (partition_ == Partition::hash)
+      {
+        return std::hash<std::string_view>{}(word) % shards_.size();
+      }
+      return word.empty() ? 0 : static_cast<unsigned char>(word.front()) % shards_.size();
+    }
+
+    /**
+     * @brief Merge the byte-ordered results @p query returns on each shard, keeping the first @p limit.
+     */
+    template <typename Query>
+    std::vector<std::string> merge_pages(Query &&query, std::size_t limit) const
+    {
+      std::vector<std::string> merged;
+      for (const auto &s : shards_)
+      {
+        std::vector<std::string> part = query(*s);
+        std::vector<std::string> next;
+        next.reserve(merged.size() + part.size());
+        std::merge(std::make_move_iterator(merged.begin()), std::make_move_iterator(merged.end()),
+                   std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()),
+                   std::back_inserter(next));
+        if (limit != 0 && next.size() > limit)
+        {
+          next.resize(limit);
+        }
+        merged = std::move(next);
+      }
+      return merged;
+    }
+
+    Trie &shard_of(std::string_view word) const noexcept { return *shards_[index_of(word)]; }
+
+    static const TrieNode *find(const TrieNode *node, std::string_view prefix) noexcept
+    {
+      for (char c : prefix)
+      {
+        node = node->children.find(c);
+        if (!node)
+        {
+          return nullptr;
+        }
+      }
+      return node;
+    }
+
+    static std::vector<std::string> ranked(detail::QueryScratch &sc, std::size_t limit)
+    {
+      std::vector<std::string> out;
+      const auto append = [&out](std::string_view word)
+      { out.emplace_back(word); };
+      detail::emit_ranked(sc, limit, append);
+      return out;
+    }
+
+    std::vector<std::unique_ptr<Trie>> shards_;
+    Partition partition_;
+  };
+
+} // namespace trie
+
+#endif // TRIE_SHARDED_TRIE_HPP
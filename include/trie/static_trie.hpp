@@ -0,0 +1,305 @@
+/**
+ * @file static_trie.hpp
+ * @brief Trie over a keyword set fixed at compile time, built by the compiler.
+ *
+ * Notes:
+ * - StaticTrie<"get", "set", ...> builds its nodes in a constant expression.
+ *   The result is a constexpr array in read-only data: no heap, no startup
+ *   work, and contains() can run in static_assert.
+ * - Nodes are laid out breadth-first. The children of a node are contiguous
+ *   and sorted by unsigned byte, so a lookup is a binary search over a few
+ *   bytes per level and suggestions come back in byte order.
+ * - Every node records its parent, so suggest() walks the subtree without a
+ *   stack and its key buffer is sized by the longest word. It never allocates
+ *   unless the vector overload is used.
+ */
+
+#ifndef TRIE_STATIC_TRIE_HPP
+#define TRIE_STATIC_TRIE_HPP
+
+#include <trie/detail/scoring.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trie
+{
+  /**
+   * @brief String literal usable as a template argument: StaticTrie<"key">.
+   */
+  template <std::size_t N>
+  struct FixedString final
+  {
+    char data[N]{};
+
+    constexpr FixedString(const char (&s)[N]) noexcept
+    {
+      std::copy(s, s + N, data);
+    }
+
+    constexpr std::string_view view() const noexcept { return {data, N - 1}; }
+  };
+
+  namespace detail
+  {
+    /**
+     * @brief Node of a StaticTrie. Children are [first_child, first_child + child_count).
+     */
+    struct StaticNode final
+    {
+      std::uint32_t first_child{0};
+      std::uint32_t parent{0};
+      std::uint16_t child_count{0};
+      unsigned char label{0};
+      bool is_terminal{false};
+    };
+
+    /**
+     * @brief Breadth-first nodes of a word set, in an array of @p Capacity slots.
+     */
+    template <std::size_t Capacity>
+    struct StaticTree final
+    {
+      std::array<StaticNode, Capacity> nodes{};
+      std::size_t node_count{1};
+      std::size_t word_count{0};
+      std::size_t max_length{0};
+    };
+
+    /**
+     * @brief Build the tree of @p words. @p Capacity must be at least 1 + their total length.
+     */
+    template <std::size_t Capacity, std::size_t Count>
+    constexpr StaticTree<Capacity> build_static_tree(std::array<std::string_view, Count> words)
+    {
+      std::sort(words.begin(), words.end());
+      const auto unique_end = std::unique(words.begin(), words.end());
+
+      // Insertion order tree. Sorted input appends every new child after its
+      // siblings, so sibling lists come out in byte order.
+      struct Building
+      {
+        unsigned char label{0};
+        bool is_terminal{false};
+        std::size_t first_child{0};
+        std::size_t last_child{0};
+        std::size_t next_sibling{0};
+        std::size_t child_count{0};
+      };
+      std::array<Building, Capacity> building{};
+      std::size_t size = 1;
+
+      StaticTree<Capacity> tree;
+      for (auto it = words.begin(); it != unique_end; ++it)
+      {
+        std::size_t node = 0;
+        for (const char c : *it)
+        {
+          const auto label = static_cast<unsigned char>(c);
+          const std::size_t last = building[node].last_child;
+          if (building[node].child_count != 0 && building[last].label == label)
+          {
+            node = last;
+            continue;
+          }
+
+          const std::size_t child = size++;
+          building[child].label = label;
+          if (building[node].child_count == 0)
+          {
+            building[node].first_child = child;
+          }
+          else
+          {
+            building[last].next_sibling = child;
+          }
+          building[node].last_child = child;
+          ++building[node].child_count;
+          node = child;
+        }
+        building[node].is_terminal = true;
+        ++tree.word_count;
+        tree.max_length = std::max(tree.max_length, it->size());
+      }
+
+      // Renumber breadth-first: tree.nodes[i] is the i-th node dequeued.
+      std::array<std::size_t, Capacity> order{};
+      std::size_t head = 0;
+      std::size_t tail = 1;
+      while (head < tail)
+      {
+        const std::size_t index = head;
+        const Building &b = building[order[head++]];
+
+        StaticNode &n = tree.nodes[index];
+        n.label = b.label;
+        n.is_terminal = b.is_terminal;
+        n.first_child = static_cast<std::uint32_t>(tail);
+        n.child_count = static_cast<std::uint16_t>(b.child_count);
+
+        for (std::size_t c = b.first_child, i = 0; i < b.child_count; c = building[c].next_sibling, ++i)
+        {
+          tree.nodes[tail].parent = static_cast<std::uint32_t>(index);
+          order[tail++] = c;
+        }
+      }
+      tree.node_count = size;
+      return tree;
+    }
+
+    /**
+     * @brief The first N elements of @p from.
+     */
+    template <std::size_t N, typename T, std::size_t M>
+    constexpr std::array<T, N> truncate(const std::array<T, M> &from) noexcept
+    {
+      std::array<T, N> out{};
+      std::copy(from.begin(), from.begin() + N, out.begin());
+      return out;
+    }
+  } // namespace detail
+
+  /**
+   * @brief Read-only trie over @p Words, built at compile time.
+   *
+   * Features:
+   * - contains(word) (constexpr)
+   * - suggest(prefix, limit), suggest(prefix, limit, visit)
+   * - size(), node_count()
+   *
+   * Duplicate words are stored once.
+   *
+   * Thread safety:
+   * - Immutable and stateless: any number of threads may query it.
+   */
+  template <FixedString... Words>
+  class StaticTrie final
+  {
+    static constexpr std::size_t capacity = (std::size_t{1} + ... + Words.view().size());
+    static constexpr detail::StaticTree<capacity> tree =
+        detail::build_static_tree<capacity>(std::array<std::string_view, sizeof...(Words)>{Words.view()...});
+
+  public:
+    /// Length of the longest word.
+    static constexpr std::size_t max_length = tree.max_length;
+
+    static constexpr std::size_t size() noexcept { return tree.word_count; }
+    static constexpr std::size_t node_count() noexcept { return tree.node_count; }
+
+    /**
+     * @brief Check if @p word is one of the words.
+     */
+    static constexpr bool contains(std::string_view word) noexcept
+    {
+      const std::uint32_t node = locate(word);
+      return node != npos && nodes[node].is_terminal;
+    }
+
+    /**
+     * @brief Words starting with @p prefix, in byte order.
+     * @param limit Max number of results. If 0, returns all matches.
+     */
+    static std::vector<std::string> suggest(std::string_view prefix, std::size_t limit = 0)
+    {
+      std::vector<std::string> out;
+      suggest(prefix, limit, [&out](std::string_view word)
+              { out.emplace_back(word); });
+      return out;
+    }
+
+    /**
+     * @brief Visit the words starting with @p prefix in byte order, without allocating.
+     *
+     * The view passed to @p visit is valid during the call only. A visitor
+     * may return false to stop.
+     * @return Number of words visited.
+     */
+    template <typename Visitor>
+    static constexpr std::size_t suggest(std::string_view prefix, std::size_t limit, Visitor &&visit)
+    {
+      const std::uint32_t start = locate(prefix);
+      if (start == npos)
+      {
+        return 0;
+      }
+
+      std::array<char, max_length + 1> key{};
+      std::copy(prefix.begin(), prefix.end(), key.begin());
+      std::size_t depth = prefix.size();
+      std::size_t count = 0;
+
+      // Preorder without a stack: descend to the first child, else move to the
+      // next sibling, climbing through parents until one has it.
+      std::uint32_t node = start;
+      for (;;)
+      {
+        if (nodes[node].is_terminal)
+        {
+          ++count;
+          if (!detail::emit(visit, std::string_view(key.data(), depth)) || (limit != 0 && count >= limit))
+          {
+            return count;
+          }
+        }
+
+        if (nodes[node].child_count != 0)
+        {
+          node = nodes[node].first_child;
+          key[depth++] = static_cast<char>(nodes[node].label);
+          continue;
+        }
+
+        for (;;)
+        {
+          if (node == start)
+          {
+            return count;
+          }
+          const detail::StaticNode &parent = nodes[nodes[node].parent];
+          if (node + 1 < parent.first_child + parent.child_count)
+          {
+            ++node;
+            key[depth - 1] = static_cast<char>(nodes[node].label);
+            break;
+          }
+          node = nodes[node].parent;
+          --depth;
+        }
+      }
+    }
+
+  private:
+    static constexpr std::uint32_t npos = ~std::uint32_t{0};
+
+    static constexpr std::array<detail::StaticNode, tree.node_count> nodes =
+        detail::truncate<tree.node_count>(tree.nodes);
+
+    static constexpr std::uint32_t locate(std::string_view key) noexcept
+    {
+      std::uint32_t node = 0;
+      for (const char c : key)
+      {
+        const detail::StaticNode &n = nodes[node];
+        const auto label = static_cast<unsigned char>(c);
+        const auto first = nodes.begin() + n.first_child;
+        const auto last = first + n.child_count;
+        const auto it = std::lower_bound(first, last, label, [](const detail::StaticNode &a, unsigned char b)
+                                         { return a.label < b; });
+        if (it == last || it->label != label)
+        {
+          return npos;
+        }
+        node = static_cast<std::uint32_t>(it - nodes.begin());
+      }
+      return node;
+    }
+  };
+
+} // namespace trie
+
+#endif // TRIE_STATIC_TRIE_HPP
@@ -0,0 +1,111 @@
+/**
+ * @file stats.hpp
+ * @brief Memory and shape report shared by the mutable tries.
+ *
+ * Notes:
+ * - Byte counts are what the structure uses, not what it reserved: the gap
+ *   to reserved_bytes is arena slack (freed blocks and the unused tail of the
+ *   last chunk).
+ * - Stats are gathered by one walk over every node under the read lock.
+ */
+
+#ifndef TRIE_STATS_HPP
+#define TRIE_STATS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace trie
+{
+  /**
+   * @brief Footprint and shape of a trie, as returned by stats().
+   */
+  struct TrieStats final
+  {
+    std::size_t nodes{0};
+    std::size_t terminals{0};
+    /// nodes * sizeof(node). Includes children stored inline in the node.
+    std::size_t node_bytes{0};
+    /// Out-of-line child blocks, including their unused capacity.
+    std::size_t child_map_bytes{0};
+    /// Unused capacity inside child_map_bytes. shrink_to_fit() brings it to 0.
+    std::size_t child_map_slack_bytes{0};
+    /// Key bytes stored outside the nodes (radix edge labels). 0 for Trie,
+    /// whose labels are the child-map keys.
+    std::size_t payload_bytes{0};
+    /// Bytes obtained from the memory resource.
+    std::size_t reserved_bytes{0};
+    /// fanout[c]: number of nodes with c children.
+    std::vector<std::size_t> fanout{};
+    /// depth[d]: number of nodes d levels below the root (the root is depth 0).
+    std::vector<std::size_t> depth{};
+
+    /// Sum of node, child map and payload bytes.
+    std::size_t used_bytes() const noexcept { return node_bytes + child_map_bytes + payload_bytes; }
+
+    TrieStats &operator+=(const TrieStats &other)
+    {
+      nodes += other.nodes;
+      terminals += other.terminals;
+      node_bytes += other.node_bytes;
+      child_map_bytes += other.child_map_bytes;
+      child_map_slack_bytes += other.child_map_slack_bytes;
+      payload_bytes += other.payload_bytes;
+      reserved_bytes += other.reserved_bytes;
+      add_histogram(fanout, other.fanout);
+      add_histogram(depth, other.depth);
+      return *this;
+    }
+
+  private:
+    static void add_histogram(std::vector<std::size_t> &into, const std::vector<std::size_t> &from)
+    {
+      into.resize(std::max(into.size(), from.size()), 0);
+      for (std::size_t i = 0; i < from.size(); ++i)
+      {
+        into[i] += from[i];
+      }
+    }
+  };
+
+  namespace detail
+  {
+    /**
+     * @brief Count one node, terminal if @p terminal, @p depth levels below the root.
+     */
+    template <typename Node>
+    void record_node(TrieStats &s, const Node &node, std::size_t depth, bool terminal)
+    {
+      const std::size_t children = node.children.size();
+      ++s.nodes;
+      s.terminals += terminal ? 1 : 0;
+      s.node_bytes += sizeof(Node);
+      s.child_map_bytes += node.children.storage_bytes();
+      s.child_map_slack_bytes += node.children.slack_bytes();
+
+      if (s.fanout.size() <= children)
+      {
+        s.fanout.resize(children + 1, 0);
+      }
+      ++s.fanout[children];
+      if (s.depth.size() <= depth)
+      {
+        s.depth.resize(depth + 1, 0);
+      }
+      ++s.depth[depth];
+    }
+
+    /**
+     * @brief record_node() for nodes with an is_terminal flag.
+     */
+    template <typename Node>
+    void record_node(TrieStats &s, const Node &node, std::size_t depth)
+    {
+      record_node(s, node, depth, node.is_terminal);
+    }
+  } // namespace detail
+
+} // namespace trie
+
+#endif // TRIE_STATS_HPP
@@ -4,81 +4,450 @@
  *
  * Notes:
  * - Stores UTF-8 bytes as-is (char). For full Unicode grapheme support, preprocess input upstream.
+ * - For case- and accent-insensitive lookups, use FoldedTrie (folded_trie.hpp).
  * - This library is intentionally small and deterministic.
  */
 
 #ifndef TRIE_TRIE_HPP
 #define TRIE_TRIE_HPP
 
+#include <trie/detail/arena.hpp>
+#include <trie/detail/child_map.hpp>
+#include <trie/detail/epoch.hpp>
+#include <trie/detail/parallel.hpp>
+#include <trie/detail/prefetch.hpp>
+#include <trie/detail/rw_lock.hpp>
+#include <trie/detail/scoring.hpp>
+#include <trie/detail/sorted_input.hpp>
+#include <trie/flat_trie.hpp>
+#include <trie/instrumentation.hpp>
+#include <trie/query_context.hpp>
+#include <trie/stats.hpp>
+
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <ostream>
+#include <optional>
+#include <queue>
+#include <set>
+#include <span>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace trie
 {
+  /**
+   * @brief Word frequency counter. 64 bits, so hot terms fed from large logs do not wrap.
+   */
+  using Frequency = std::uint64_t;
+
   /**
    * @brief Trie node.
+   *
+   * Children are kept in a compact adaptive container: a sorted inline array for
+   * low fan-out and a bitmap-indexed table for high fan-out.
+   *
+   * Nodes are allocated from the owning trie's arena and are trivially destructible.
    */
   struct TrieNode final
   {
-    std::unordered_map<char, std::unique_ptr<TrieNode>> children{};
+    detail::ChildMap<TrieNode> children{};
     bool is_terminal{false};
-    std::uint32_t frequency{0};
+    Frequency frequency{0};
+    /// Highest terminal frequency in this node's subtree, including itself.
+    Frequency max_frequency{0};
+  };
+
+  static_assert(std::is_trivially_destructible_v<TrieNode>,
+                "trie nodes are released with their arena and never destructed");
+
+  /**
+   * @brief Locking strategy of a Trie.
+   */
+  enum class Concurrency : std::uint8_t
+  {
+    /// No locking. The caller serializes all access.
+    none,
+    /// Every operation, read or write, takes the same exclusive lock.
+    exclusive,
+    /// Reads share a read-optimized reader-writer lock, writes take it exclusively.
+    /// Readers touch only a per-thread slot, so they scale across cores, and
+    /// pending writers block new readers, so writers are never starved.
+    shared,
+    /// Readers never block: they pin an epoch and traverse an immutable snapshot.
+    /// Writers serialize on a mutex, path-copy the nodes they change, publish a
+    /// new root atomically and reclaim old versions once no reader can see them.
+    snapshot,
   };
 
+  class ShardedTrie;
+  class TrieLoader;
+
   /**
    * @brief Autocomplete trie with optional ranked fuzzy search.
    *
    * Features:
-   * - insert(word)
-   * - contains(word)
-   * - suggest(prefix, limit)
-   * - search_ranked(query, limit)
+   * - insert(word), insert(word, weight), merge_counts(counts)
+   * - erase(word), add_frequency(word, delta)
+   * - contains(word), contains_many(words, found)
+   * - suggest(prefix, limit), suggest_many(prefixes, limit)
+   * - suggest_after(prefix, last_key, limit): byte-ordered pages
+   * - suggest_top(prefix, k)
+   * - cursor(max_distance): incremental type-ahead session
+   * - search_ranked(query, limit), search_ranked_parallel(query, limit, workers)
+   * - search_fuzzy(query, max_distance, limit)
+   * - build_from_sorted(words): bulk load in one pass
+   * - to_flat() / save(out): compact image for FlatTrieView and MappedTrie
+   * - freeze(): serve reads from a cache-ordered flat copy until the next write
+   * - stats(), shrink_to_fit(): memory accounting and compaction
+   * - generation(): mutation counter, e.g. for QueryCache
+   *
+   * Queries:
+   * - Words and queries are passed as std::string_view.
+   * - suggest(), search_ranked() and search_fuzzy() also have visitor overloads that
+   *   call `visit(std::string_view word)` for each result instead of building a
+   *   vector. A visitor may return bool; returning false stops the query. With a
+   *   reused QueryContext these overloads run without allocating.
+   * - Visitors run while the read side of the trie is held. They must not insert.
+   *
+   * Memory:
+   * - Nodes and child blocks are carved from an arena backed by a std::pmr::memory_resource.
+   * - Destroying the trie releases whole chunks. There is no per-node teardown.
+   * - stats() reports where the bytes go; shrink_to_fit() drops growth slack.
+   * - freeze() keeps the nodes and adds a flat image beside them, about
+   *   25 bytes per node, freed by the next write.
    *
    * Thread safety:
    * - By default, this class is NOT thread-safe.
    * - If you need concurrent operations, enable locking by passing thread_safe=true to the constructor.
+   * - For read-heavy workloads, pass Concurrency::shared so that contains(), suggest()
+   *   and the ranked searches run in parallel and only insert() is exclusive.
+   * - Concurrency::snapshot makes reads lock-free. Each read sees the trie as of
+   *   one committed insert; insert() costs a copy of every node on the word's path.
    */
   class Trie final
   {
+    /// Runs cross-shard queries on the shards' nodes under their own read locks.
+    friend class ShardedTrie;
+    /// Copies partitions built in parallel under one root.
+    friend class TrieLoader;
+
   public:
     /**
      * @brief Construct an empty trie.
      * @param thread_safe If true, operations lock an internal mutex.
+     * @param resource Upstream memory resource for node chunks. Defaults to the
+     *        current default resource.
      */
-    explicit Trie(bool thread_safe = false)
-        : root_(std::make_unique<TrieNode>()),
-          thread_safe_(thread_safe)
+    explicit Trie(bool thread_safe = false,
+                  std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : Trie(thread_safe ? Concurrency::exclusive : Concurrency::none, resource)
+    {
+    }
+
+    /**
+     * @brief Construct an empty trie with an explicit locking strategy.
+     * @param concurrency Locking strategy.
+     * @param resource Upstream memory resource for node chunks.
+     */
+    explicit Trie(Concurrency concurrency,
+                  std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : arena_(resource),
+          root_(arena_.create<TrieNode>()),
+          concurrency_(concurrency)
+    {
+      if (concurrency_ == Concurrency::shared)
+      {
+        rw_ = std::make_unique<detail::ReaderWriterLock>();
+      }
+      else if (concurrency_ == Concurrency::snapshot)
+      {
+        epoch_ = std::make_unique<detail::EpochDomain>();
+      }
+    }
+
+    /**
+     * @brief Construct an empty, non-locking trie over @p resource.
+     */
+    explicit Trie(std::pmr::memory_resource *resource)
+        : Trie(false, resource)
+    {
+    }
+
+    ~Trie()
     {
+      delete frozen_.load(std::memory_order_relaxed);
     }
 
     /**
      * @brief Insert a word into the trie.
      * @param word The word to insert.
      */
-    void insert(const std::string &word)
+    void insert(std::string_view word)
+    {
+      detail::ScopedOperation measure(Operation::insert);
+      WriteLock lock(*this);
+      add_weight(word, 1);
+    }
+
+    /**
+     * @brief Insert a word, or raise its frequency, by @p weight in one traversal.
+     */
+    void insert(std::string_view word, Frequency weight)
+    {
+      detail::ScopedOperation measure(Operation::insert);
+      WriteLock lock(*this);
+      add_weight(word, weight);
+    }
+
+    /**
+     * @brief Remove a word from the trie.
+     *
+     * Nodes left without a word below them are pruned and max_frequency is
+     * recomputed along the path.
+     * @return true if the word was present.
+     */
+    bool erase(std::string_view word)
+    {
+      detail::ScopedOperation measure(Operation::erase);
+      WriteLock lock(*this);
+      if (!find_terminal(word))
+      {
+        return false;
+      }
+      lower_frequency(word, 0);
+      return true;
+    }
+
+    /**
+     * @brief Add @p delta to the frequency of a word.
+     *
+     * A positive delta inserts the word if it is missing. A negative delta
+     * lowers the frequency and erases the word once it reaches zero; it does
+     * nothing for a missing word. Frequencies saturate at the top of their range.
+     * @return The word's new frequency, 0 if it is not in the trie.
+     */
+    Frequency add_frequency(std::string_view word, std::int64_t delta)
+    {
+      detail::ScopedOperation measure(Operation::insert);
+      WriteLock lock(*this);
+
+      const TrieNode *node = find_terminal(word);
+      const Frequency current = node ? node->frequency : 0;
+
+      if (delta > 0)
+      {
+        add_weight(word, static_cast<Frequency>(delta));
+        return find_terminal(word)->frequency;
+      }
+      if (!node || delta == 0)
+      {
+        return current;
+      }
+
+      const Frequency decrement = static_cast<Frequency>(-(delta + 1)) + 1;
+      const Frequency target = current > decrement ? current - decrement : 0;
+      lower_frequency(word, target);
+      return target;
+    }
+
+    /**
+     * @brief Frequency of a word, 0 if it is not in the trie.
+     */
+    Frequency frequency(std::string_view word) const
     {
-      LockGuard lock(*this);
+      detail::ScopedOperation measure(Operation::contains);
+      ReadLock lock(*this);
+      if (const FlatTrieView *view = lock.frozen())
+      {
+        return view->frequency(word);
+      }
 
-      TrieNode *node = root_.get();
+      const TrieNode *node = lock.root();
       for (char c : word)
       {
-        auto &next = node->children[c];
-        if (!next)
+        detail::count_nodes(1);
+        node = node->children.find(c);
+        if (!node)
         {
-          next = std::make_unique<TrieNode>();
+          return 0;
         }
-        node = next.get();
       }
+      return node->is_terminal ? node->frequency : 0;
+    }
 
-      node->is_terminal = true;
-      node->frequency += 1;
+    /**
+     * @brief Mutation counter. Strictly increases with every insert, erase or
+     *        frequency change, and is bumped once a change is visible to readers.
+     */
+    std::uint64_t generation() const noexcept { return generation_.load(); }
+
+    /**
+     * @brief Add a batch of word counts in one pass.
+     *
+     * Elements are words (count 1) or (word, count) pairs, in any order. The
+     * batch is sorted and repeated words are summed, then applied in one walk
+     * that reuses the path shared with the previous word. Snapshot mode copies
+     * each touched node once and publishes the batch as one version.
+     *
+     * Words of ranges that yield elements by value are copied for the sort.
+     * Throws std::invalid_argument on a negative count, before any change.
+     */
+    template <typename Range>
+    void merge_counts(const Range &counts)
+    {
+      detail::ScopedOperation measure(Operation::insert);
+      std::vector<detail::SortedEntry> entries;
+      std::deque<std::string> owned;
+      for (const auto &element : counts)
+      {
+        detail::SortedEntry e = detail::sorted_entry(element);
+        if constexpr (!detail::yields_lvalues_v<Range>)
+        {
+          e.word = owned.emplace_back(e.word);
+        }
+        entries.push_back(e);
+      }
+
+      std::sort(entries.begin(), entries.end(),
+                [](const detail::SortedEntry &a, const detail::SortedEntry &b)
+                { return a.word < b.word; });
+
+      std::size_t unique = 0;
+      for (const detail::SortedEntry &e : entries)
+      {
+        if (unique != 0 && entries[unique - 1].word == e.word)
+        {
+          entries[unique - 1].frequency = detail::saturating_add(entries[unique - 1].frequency, e.frequency);
+        }
+        else
+        {
+          entries[unique++] = e;
+        }
+      }
+      entries.resize(unique);
+
+      if (entries.empty())
+      {
+        return;
+      }
+
+      WriteLock lock(*this);
+      merge_sorted(entries);
+    }
+
+    /**
+     * @brief Fill an empty trie from a sorted range, in one pass.
+     *
+     * Elements are words, or (word, frequency) pairs, in ascending unsigned byte
+     * order; a repeated word adds to the previous frequency. Each node's children
+     * are collected before the node is closed and stored in one exactly sized
+     * block, so the build does no lookups and no child-map growth.
+     *
+     * Throws std::logic_error if the trie is not empty and std::invalid_argument
+     * if the input is out of order. On an exception the trie stays empty.
+     */
+    template <typename Range>
+    void build_from_sorted(const Range &words)
+    {
+      detail::ScopedOperation measure(Operation::insert);
+      WriteLock lock(*this);
+
+      TrieNode *old_root = root_.load(std::memory_order_relaxed);
+      if (old_root->is_terminal || !old_root->children.empty())
+      {
+        throw std::logic_error("trie: build_from_sorted needs an empty trie");
+      }
+
+      // Readers of a snapshot trie may hold the old root, so build beside it.
+      TrieNode *root = (concurrency_ == Concurrency::snapshot) ? arena_.create<TrieNode>() : old_root;
+
+      std::vector<TrieNode *> path{root};
+      std::vector<typename detail::ChildMap<TrieNode>::value_type> pending;
+      std::vector<std::size_t> starts{0};
+      std::string key;
+
+      // Close the deepest open node: hand it its children and fold their max_frequency.
+      const auto close = [&]
+      {
+        TrieNode *node = path.back();
+        const std::size_t first = starts.back();
+        for (std::size_t i = first; i < pending.size(); ++i)
+        {
+          node->max_frequency = std::max(node->max_frequency, pending[i].second->max_frequency);
+        }
+        node->children.assign_sorted(pending.data() + first, pending.size() - first, arena_);
+        pending.resize(first);
+        path.pop_back();
+        starts.pop_back();
+      };
+
+      try
+      {
+        for (const auto &element : words)
+        {
+          const detail::SortedEntry e = detail::sorted_entry(element);
+          const std::size_t common = detail::sorted_common_prefix(key, e.word);
+
+          while (key.size() > common)
+          {
+            close();
+            key.pop_back();
+          }
+
+          for (std::size_t i = common; i < e.word.size(); ++i)
+          {
+            TrieNode *child = arena_.create<TrieNode>();
+            pending.emplace_back(e.word[i], child);
+            path.push_back(child);
+            starts.push_back(pending.size());
+            key.push_back(e.word[i]);
+          }
+
+          TrieNode *node = path.back();
+          node->is_terminal = true;
+          node->frequency = detail::saturating_add(node->frequency, e.frequency);
+          node->max_frequency = std::max(node->max_frequency, node->frequency);
+        }
+      }
+      catch (...)
+      {
+        // Nodes already created stay in the arena until it is released.
+        root->is_terminal = false;
+        root->frequency = 0;
+        root->max_frequency = 0;
+        throw;
+      }
+
+      while (!path.empty())
+      {
+        close();
+      }
+
+      if (root != old_root)
+      {
+        root_.store(root, std::memory_order_release);
+        generation_.fetch_add(1);
+        retire_node(old_root);
+        epoch_->collect(arena_);
+      }
+      else
+      {
+        generation_.fetch_add(1);
+      }
     }
 
     /**
@@ -86,213 +455,1771 @@ namespace trie
      * @param word The word to look up.
      * @return true if present, false otherwise.
      */
-    bool contains(const std::string &word) const
+    bool contains(std::string_view word) const
     {
-      LockGuard lock(*this);
+      detail::ScopedOperation measure(Operation::contains);
+      ReadLock lock(*this);
+      if (const FlatTrieView *view = lock.frozen())
+      {
+        return view->contains(word);
+      }
 
-      const TrieNode *node = root_.get();
+      const TrieNode *node = lock.root();
       for (char c : word)
       {
-        const auto it = node->children.find(c);
-        if (it == node->children.end())
+        detail::count_nodes(1);
+        node = node->children.find(c);
+        if (!node)
         {
           return false;
         }
-        node = it->second.get();
       }
       return node->is_terminal;
     }
 
     /**
-     * @brief Return prefix suggestions.
-     * @param prefix Prefix to complete.
-     * @param limit Max number of results. If 0, returns all matches.
+     * @brief Look up a batch of words under one lock acquisition.
+     *
+     * found[i] is set to contains(words[i]). Keys are walked in interleaved
+     * groups with the next node of each prefetched, so the cache misses of
+     * different keys overlap. Throws std::invalid_argument if @p found is
+     * shorter than @p words.
      */
-    std::vector<std::string> suggest(const std::string &prefix, std::size_t limit = 0) const
+    void contains_many(std::span<const std::string_view> words, std::span<bool> found) const
     {
-      LockGuard lock(*this);
+      if (found.size() < words.size())
+      {
+        throw std::invalid_argument("trie: contains_many result span is too short");
+      }
 
-      const TrieNode *node = root_.get();
-      for (char c : prefix)
+      detail::ScopedOperation measure(Operation::contains);
+      ReadLock lock(*this);
+      if (const FlatTrieView *view = lock.frozen())
       {
-        const auto it = node->children.find(c);
-        if (it == node->children.end())
+        for (std::size_t i = 0; i < words.size(); ++i)
         {
-          return {};
+          found[i] = view->contains(words[i]);
         }
-        node = it->second.get();
+        return;
       }
+      locate_many(lock.root(), words, [&found](std::size_t i, const TrieNode *node)
+                  { found[i] = node && node->is_terminal; });
+    }
 
+    /**
+     * @brief Return prefix suggestions.
+     * @param prefix Prefix to complete.
+     * @param limit Max number of results. If 0, returns all matches.
+     */
+    std::vector<std::string> suggest(std::string_view prefix, std::size_t limit = 0) const
+    {
+      QueryContext ctx;
       std::vector<std::string> out;
-      std::string current = prefix;
-      collect_suggestions(node, current, out, limit);
+      suggest(prefix, limit, ctx, [&out](std::string_view word)
+              { out.emplace_back(word); });
       return out;
     }
 
     /**
-     * @brief Ranked fuzzy search.
-     *
-     * Scans all terminal words in the trie and ranks them against @p query.
-     * This is intentionally simple and deterministic.
-     *
-     * @param query Query string.
-     * @param limit Max number of results. If 0, returns all matches.
+     * @brief Visit prefix suggestions.
+     * @param prefix Prefix to complete.
+     * @param limit Max number of results. If 0, visits all matches.
+     * @param visit Called with each completion. The view is valid during the call only.
+     * @return Number of words visited.
      */
-    std::vector<std::string> search_ranked(const std::string &query, std::size_t limit = 10) const
+    template <typename Visitor>
+    std::size_t suggest(std::string_view prefix, std::size_t limit, Visitor &&visit) const
     {
-      LockGuard lock(*this);
+      QueryContext ctx;
+      return suggest(prefix, limit, ctx, visit);
+    }
 
-      std::vector<ScoredWord> scored;
-      std::string current;
-      collect_scored(root_.get(), current, scored, query);
+    /**
+     * @brief Visit prefix suggestions using the buffers of @p ctx.
+     */
+    template <typename Visitor>
+    std::size_t suggest(std::string_view prefix, std::size_t limit, QueryContext &ctx, Visitor &&visit) const
+    {
+      detail::ScopedOperation measure(Operation::suggest);
+      ReadLock lock(*this);
+      if (const FlatTrieView *view = lock.frozen())
+      {
+        return view->suggest(prefix, limit, ctx, visit);
+      }
 
-      std::sort(scored.begin(), scored.end(), [](const auto &a, const auto &b)
-                {
-        if (a.score != b.score) return a.score > b.score;
-        return a.word < b.word; });
+      const TrieNode *node = lock.root();
+      for (char c : prefix)
+      {
+        detail::count_nodes(1);
+        node = node->children.find(c);
+        if (!node)
+        {
+          return 0;
+        }
+      }
 
-      const std::size_t take = (limit == 0) ? scored.size() : std::min(limit, scored.size());
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      sc.key.assign(prefix);
+      std::size_t count = 0;
+      collect_suggestions(node, sc, limit, count, visit);
+      return count;
+    }
 
+    /**
+     * @brief One page of suggestions: the words starting with @p prefix that
+     *        sort strictly after @p last_key, in byte order.
+     *
+     * Pass the last word of the previous page as @p last_key (empty for the
+     * first page). The walk resumes from the path of @p last_key instead of
+     * re-collecting the skipped words, so a page costs O(|last_key| + page).
+     * @param limit Max number of results. If 0, returns all remaining matches.
+     */
+    std::vector<std::string> suggest_after(
+        std::string_view prefix,
+        std::string_view last_key,
+        std::size_t limit) const
+    {
+      QueryContext ctx;
       std::vector<std::string> out;
-      out.reserve(take);
-
-      for (std::size_t i = 0; i < take; ++i)
-      {
-        out.push_back(scored[i].word);
-      }
+      suggest_after(prefix, last_key, limit, ctx, [&out](std::string_view word)
+                    { out.emplace_back(word); });
       return out;
     }
 
-  private:
-    struct ScoredWord final
+    /**
+     * @brief Visit one page of suggestions using the buffers of @p ctx.
+     * @return Number of words visited.
+     */
+    template <typename Visitor>
+    std::size_t suggest_after(
+        std::string_view prefix,
+        std::string_view last_key,
+        std::size_t limit,
+        QueryContext &ctx,
+        Visitor &&visit) const
     {
-      std::string word;
-      double score{0.0};
-    };
+      detail::ScopedOperation measure(Operation::suggest);
+      ReadLock lock(*this);
 
-    class LockGuard final
-    {
-    public:
-      explicit LockGuard(const Trie &t)
-          : t_(t)
+      const TrieNode *node = lock.root();
+      for (char c : prefix)
       {
-        if (t_.thread_safe_)
+        detail::count_nodes(1);
+        node = node->children.find(c);
+        if (!node)
         {
-          t_.mtx_.lock();
-          locked_ = true;
+          return 0;
         }
       }
 
-      ~LockGuard()
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      std::size_t count = 0;
+
+      if (last_key.substr(0, prefix.size()) != prefix)
       {
-        if (locked_)
+        // last_key sorts either before every word with the prefix or after all of them.
+        if (last_key > prefix)
         {
-          t_.mtx_.unlock();
+          return 0;
         }
+        sc.key.assign(prefix);
+        collect_suggestions(node, sc, limit, count, visit);
+        return count;
       }
 
-      LockGuard(const LockGuard &) = delete;
-      LockGuard &operator=(const LockGuard &) = delete;
+      // Queue, shallow to deep, the subtrees that sort after last_key: at each
+      // node on its path the children with a greater byte, then everything
+      // below last_key itself. Deeper entries pop first, in byte order.
+      sc.key.assign(prefix);
+      sc.stack.clear();
+      for (std::size_t i = prefix.size(); node; ++i)
+      {
+        if (i == last_key.size())
+        {
+          push_children(sc, node);
+          break;
+        }
+
+        const auto next = static_cast<unsigned char>(last_key[i]);
+        const std::size_t mark = sc.stack.size();
+        const auto key_size = static_cast<std::uint32_t>(i);
+        for (const auto &kv : node->children)
+        {
+          if (static_cast<unsigned char>(kv.first) > next)
+          {
+            sc.stack.push_back(detail::Frame{reinterpret_cast<std::uintptr_t>(kv.second),
+                                             key_size,
+                                             static_cast<unsigned char>(kv.first)});
+          }
+        }
+        std::reverse(sc.stack.begin() + static_cast<std::ptrdiff_t>(mark), sc.stack.end());
 
-    private:
-      const Trie &t_;
-      bool locked_{false};
-    };
+        detail::count_nodes(1);
+        node = node->children.find(last_key[i]);
+        sc.key.push_back(last_key[i]);
+      }
 
-    static void collect_suggestions(
-        const TrieNode *node,
-        std::string &current,
-        std::vector<std::string> &out,
-        std::size_t limit)
+      walk_suggestions(next_frame(sc), sc, limit, count, visit);
+      return count;
+    }
+
+    /**
+     * @brief suggest() for a batch of prefixes under one lock acquisition.
+     *
+     * Result i holds the suggestions for prefixes[i].
+     */
+    std::vector<std::vector<std::string>> suggest_many(
+        std::span<const std::string_view> prefixes,
+        std::size_t limit = 0) const
     {
-      if (node->is_terminal)
-      {
-        out.push_back(current);
-        if (limit != 0 && out.size() >= limit)
+      QueryContext ctx;
+      std::vector<std::vector<std::string>> out(prefixes.size());
+      suggest_many(prefixes, limit, ctx, [&out](std::size_t i, std::string_view word)
+                   { out[i].emplace_back(word); });
+      return out;
+    }
+
+    /**
+     * @brief Visit suggestions for a batch of prefixes as `visit(i, word)`.
+     *
+     * The prefixes are located with interleaved, prefetched walks, then
+     * completed in input order. A visitor returning false stops the current
+     * prefix only.
+     * @return Total number of words visited.
+     */
+    template <typename Visitor>
+    std::size_t suggest_many(
+        std::span<const std::string_view> prefixes,
+        std::size_t limit,
+        QueryContext &ctx,
+        Visitor &&visit) const
+    {
+      detail::ScopedOperation measure(Operation::suggest);
+      ReadLock lock(*this);
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+
+      std::size_t total = 0;
+      locate_many(lock.root(), prefixes, [&](std::size_t i, const TrieNode *node)
+                  {
+        if (!node)
         {
           return;
         }
-      }
+        const auto visit_one = [&visit, i](std::string_view word)
+        { return detail::emit(visit, i, word); };
 
-      for (const auto &kv : node->children)
+        sc.key.assign(prefixes[i]);
+        std::size_t count = 0;
+        collect_suggestions(node, sc, limit, count, visit_one);
+        total += count; });
+      return total;
+    }
+
+    /**
+     * @brief Return the @p k most frequent completions of @p prefix.
+     *
+     * Best-first traversal ordered by each subtree's cached max frequency. A
+     * branch is only expanded once it can still beat the results found so far,
+     * so cost grows with @p k rather than with the size of the subtree.
+     *
+     * Ties are broken lexicographically.
+     *
+     * @param prefix Prefix to complete.
+     * @param k Max number of results. If 0, returns all matches by frequency.
+     */
+    std::vector<std::string> suggest_top(std::string_view prefix, std::size_t k) const
+    {
+      detail::ScopedOperation measure(Operation::suggest_top);
+      ReadLock lock(*this);
+      if (const FlatTrieView *view = lock.frozen())
       {
-        current.push_back(kv.first);
-        collect_suggestions(kv.second.get(), current, out, limit);
-        current.pop_back();
+        return view->suggest_top(prefix, k);
+      }
 
-        if (limit != 0 && out.size() >= limit)
+      const TrieNode *node = lock.root();
+      for (char c : prefix)
+      {
+        detail::count_nodes(1);
+        node = node->children.find(c);
+        if (!node)
         {
-          return;
+          return {};
         }
       }
+
+      const Seed seed{node, prefix, 0};
+      return best_completions(std::span<const Seed>(&seed, 1), k);
     }
 
-    static int levenshtein_distance(const std::string &a, const std::string &b)
+    /**
+     * @brief Type-ahead session: the typed prefix, its node and its fuzzy frontier.
+     *
+     * push() and pop() cost one child lookup instead of a walk from the root.
+     * With a max distance, the cursor also keeps, for every typed length, the
+     * set of trie nodes within that edit distance of the prefix, and derives the
+     * next set from the previous one (Ji et al., interactive fuzzy search), so a
+     * keystroke costs work proportional to that frontier, not to the prefix.
+     *
+     * Results:
+     * - suggest(limit): exact completions in lexicographic order
+     * - suggest_top(k): exact completions by frequency
+     * - suggest_fuzzy(k): completions of every node in the frontier, ordered by
+     *   (distance, frequency desc, word)
+     *
+     * Each call takes the trie's read side. If the trie changed since the last
+     * call, the cursor rebuilds its path from the root first. A cursor must not
+     * be used by two threads at once.
+     */
+    class Cursor final
     {
-      const std::size_t m = a.size();
-      const std::size_t n = b.size();
-
-      if (m == 0)
-        return static_cast<int>(n);
-      if (n == 0)
-        return static_cast<int>(m);
-
-      std::vector<int> prev(n + 1);
-      std::vector<int> cur(n + 1);
+    public:
+      explicit Cursor(const Trie &trie, std::size_t max_distance = 0)
+          : trie_(&trie),
+            max_distance_(static_cast<std::uint32_t>(detail::distance_bound(max_distance)))
+      {
+      }
 
-      for (std::size_t j = 0; j <= n; ++j)
+      /**
+       * @brief Append @p c to the prefix.
+       */
+      void push(char c)
       {
-        prev[j] = static_cast<int>(j);
+        ReadLock lock(*trie_);
+        sync();
+        extend(c);
       }
 
-      for (std::size_t i = 1; i <= m; ++i)
+      /**
+       * @brief Remove the last byte of the prefix. No-op on an empty prefix.
+       */
+      void pop()
       {
-        cur[0] = static_cast<int>(i);
-        for (std::size_t j = 1; j <= n; ++j)
+        if (key_.empty())
+        {
+          return;
+        }
+        key_.pop_back();
+        if (!path_.empty())
         {
-          const int cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
-          cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + cost});
+          path_.pop_back();
+          active_.resize(levels_.back());
+          levels_.pop_back();
+          pool_.resize(pool_levels_.back());
+          pool_levels_.pop_back();
         }
-        std::swap(prev, cur);
       }
 
-      return prev[n];
-    }
+      /**
+       * @brief Reset to the empty prefix.
+       */
+      void clear()
+      {
+        key_.clear();
+        path_.clear();
+      }
 
-    static double score_word(const std::string &query, const std::string &word, std::uint32_t frequency)
-    {
-      const int d = levenshtein_distance(query, word);
+      std::string_view prefix() const noexcept { return key_; }
 
-      const double sim = 1.0 / (1.0 + static_cast<double>(d));
-      const double len_bonus = static_cast<double>(word.size()) * 0.02;
-      const double freq_bonus = static_cast<double>(frequency) * 0.05;
+      /**
+       * @brief True if some word starts with the prefix.
+       */
+      bool matches()
+      {
+        ReadLock lock(*trie_);
+        sync();
+        return path_.back() != nullptr;
+      }
 
-      return sim + len_bonus + freq_bonus;
-    }
+      std::vector<std::string> suggest(std::size_t limit = 0)
+      {
+        ReadLock lock(*trie_);
+        sync();
 
-    static void collect_scored(
-        const TrieNode *node,
-        std::string &current,
-        std::vector<ScoredWord> &out,
-        const std::string &query)
-    {
-      if (node->is_terminal)
+        std::vector<std::string> out;
+        if (const TrieNode *node = path_.back())
+        {
+          detail::QueryScratch sc;
+          sc.key = key_;
+          std::size_t count = 0;
+          const auto append = [&out](std::string_view word)
+          { out.emplace_back(word); };
+          collect_suggestions(node, sc, limit, count, append);
+        }
+        return out;
+      }
+
+      std::vector<std::string> suggest_top(std::size_t k)
       {
-        out.push_back(ScoredWord{current, score_word(query, current, node->frequency)});
+        ReadLock lock(*trie_);
+        sync();
+
+        const TrieNode *node = path_.back();
+        if (!node)
+        {
+          return {};
+        }
+        const Seed seed{node, key_, 0};
+        return best_completions(std::span<const Seed>(&seed, 1), k);
       }
 
-      for (const auto &kv : node->children)
+      /**
+       * @brief Completions of every prefix within the max distance of the typed one.
+       *
+       * Same as suggest_top() when the cursor was created with max distance 0.
+       */
+      std::vector<std::string> suggest_fuzzy(std::size_t k)
+      {
+        if (max_distance_ == 0)
+        {
+          return suggest_top(k);
+        }
+
+        ReadLock lock(*trie_);
+        sync();
+
+        std::vector<Seed> seeds;
+        seeds.reserve(active_.size() - levels_.back());
+        for (std::size_t i = levels_.back(); i < active_.size(); ++i)
+        {
+          const Active &a = active_[i];
+          seeds.push_back(Seed{a.node, std::string_view(pool_).substr(a.key_offset, a.key_size), a.distance});
+        }
+        return best_completions(seeds, k);
+      }
+
+    private:
+      /**
+       * @brief A frontier node: edit distance @c distance from the prefix, key in pool_.
+       */
+      struct Active final
+      {
+        const TrieNode *node;
+        std::uint32_t key_offset;
+        std::uint32_t key_size;
+        std::uint32_t distance;
+      };
+
+      /**
+       * @brief Rebuild the cached path if it is missing or the trie changed. Call under a ReadLock.
+       *
+       * The generation is read before the root so that a root published later
+       * is always detected by the next call.
+       */
+      void sync()
+      {
+        const std::uint64_t generation = trie_->generation_.load();
+        if (!path_.empty() && generation == generation_)
+        {
+          return;
+        }
+
+        const TrieNode *root = trie_->root_.load(std::memory_order_acquire);
+        generation_ = generation;
+
+        const std::string key = std::move(key_);
+        key_.clear();
+        path_.assign(1, root);
+        active_.clear();
+        levels_.assign(1, 0);
+        pool_.clear();
+        pool_levels_.assign(1, 0);
+
+        if (max_distance_ != 0)
+        {
+          active_.push_back(Active{root, 0, 0, 0});
+          close_insertions(0);
+        }
+
+        for (char c : key)
+        {
+          extend(c);
+        }
+      }
+
+      void extend(char c)
+      {
+        const TrieNode *parent = path_.back();
+        path_.push_back(parent ? parent->children.find(c) : nullptr);
+        key_.push_back(c);
+
+        if (max_distance_ == 0)
+        {
+          // Keep the level bookkeeping aligned with path_ so that pop() is uniform.
+          levels_.push_back(active_.size());
+          pool_levels_.push_back(pool_.size());
+          return;
+        }
+
+        const std::size_t prev_begin = levels_.back();
+        const std::size_t prev_end = active_.size();
+        levels_.push_back(prev_end);
+        pool_levels_.push_back(pool_.size());
+
+        for (std::size_t i = prev_begin; i < prev_end; ++i)
+        {
+          const Active a = active_[i];
+
+          // c is deleted from the prefix.
+          if (a.distance + 1 <= max_distance_)
+          {
+            active_.push_back(Active{a.node, a.key_offset, a.key_size, a.distance + 1});
+          }
+
+          // c is matched or substituted with the next trie byte.
+          for (const auto &kv : a.node->children)
+          {
+            const std::uint32_t d = a.distance + (kv.first == c ? 0u : 1u);
+            if (d <= max_distance_)
+            {
+              push_child(a, kv, d);
+            }
+          }
+        }
+
+        dedupe(prev_end);
+        close_insertions(prev_end);
+      }
+
+      /**
+       * @brief Add nodes reached by inserting trie bytes after the prefix.
+       *
+       * Stops once no entry is deeper than the pass just expanded, so a large
+       * max distance costs at most the depth of the trie.
+       */
+      void close_insertions(std::size_t begin)
+      {
+        for (std::uint32_t d = 0; d < max_distance_; ++d)
+        {
+          const std::size_t end = active_.size();
+          for (std::size_t i = begin; i < end; ++i)
+          {
+            const Active a = active_[i];
+            if (a.distance != d)
+            {
+              continue;
+            }
+            for (const auto &kv : a.node->children)
+            {
+              push_child(a, kv, d + 1);
+            }
+          }
+          dedupe(begin);
+
+          const bool deeper = std::any_of(active_.begin() + static_cast<std::ptrdiff_t>(begin), active_.end(),
+                                          [d](const Active &a)
+                                          { return a.distance > d; });
+          if (!deeper)
+          {
+            break;
+          }
+        }
+      }
+
+      void push_child(const Active &parent, const std::pair<char, TrieNode *> &child, std::uint32_t distance)
+      {
+        const std::size_t offset = pool_.size();
+        pool_.append(parent.key_size + 1, '\0');
+        std::memcpy(pool_.data() + offset, pool_.data() + parent.key_offset, parent.key_size);
+        pool_[offset + parent.key_size] = child.first;
+        active_.push_back(Active{child.second, static_cast<std::uint32_t>(offset), parent.key_size + 1, distance});
+      }
+
+      /**
+       * @brief Keep one entry per node in [begin, end), the one with the smallest distance.
+       */
+      void dedupe(std::size_t begin)
+      {
+        const auto first = active_.begin() + static_cast<std::ptrdiff_t>(begin);
+        std::sort(first, active_.end(), [](const Active &a, const Active &b)
+                  {
+          if (a.node != b.node) return std::less<const TrieNode *>{}(a.node, b.node);
+          return a.distance < b.distance; });
+        active_.erase(std::unique(first, active_.end(), [](const Active &a, const Active &b)
+                                  { return a.node == b.node; }),
+                      active_.end());
+      }
+
+      const Trie *trie_;
+      std::uint32_t max_distance_;
+      std::uint64_t generation_{0};
+      std::string key_{};
+      /// path_[i] is the node of the first i bytes of key_, or nullptr. Empty until synced.
+      std::vector<const TrieNode *> path_{};
+      /// Frontier of prefix length i is active_[levels_[i], levels_[i + 1]).
+      std::vector<Active> active_{};
+      std::vector<std::size_t> levels_{};
+      /// Keys of the frontier nodes; pool_levels_[i] is the pool size before level i.
+      std::string pool_{};
+      std::vector<std::size_t> pool_levels_{};
+    };
+
+    /**
+     * @brief Start a type-ahead Cursor with an empty prefix.
+     * @param max_distance Edit distance for suggest_fuzzy(). 0 disables the fuzzy frontier.
+     */
+    Cursor cursor(std::size_t max_distance = 0) const
+    {
+      return Cursor(*this, max_distance);
+    }
+
+    /**
+     * @brief Ranked fuzzy search.
+     *
+     * Scans all terminal words in the trie and ranks them against @p query.
+     * This is intentionally simple and deterministic.
+     *
+     * @param query Query string.
+     * @param limit Max number of results. If 0, returns all matches.
+     */
+    std::vector<std::string> search_ranked(std::string_view query, std::size_t limit = 10) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      search_ranked(query, limit, ctx, [&out](std::string_view word)
+                    { out.emplace_back(word); });
+      return out;
+    }
+
+    /**
+     * @brief Visit ranked fuzzy search results, best first.
+     * @return Number of words visited.
+     */
+    template <typename Visitor>
+    std::size_t search_ranked(std::string_view query, std::size_t limit, Visitor &&visit) const
+    {
+      QueryContext ctx;
+      return search_ranked(query, limit, ctx, visit);
+    }
+
+    /**
+     * @brief Visit ranked fuzzy search results using the buffers of @p ctx.
+     */
+    template <typename Visitor>
+    std::size_t search_ranked(std::string_view query, std::size_t limit, QueryContext &ctx, Visitor &&visit) const
+    {
+      detail::ScopedOperation measure(Operation::search_ranked);
+      ReadLock lock(*this);
+      if (const FlatTrieView *view = lock.frozen())
+      {
+        return view->search_ranked(query, limit, ctx, visit);
+      }
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+
+      sc.reset(limit);
+      detail::prepare_distance(sc, query);
+      collect_scored(lock.root(), sc, query);
+
+      return detail::emit_ranked(sc, limit, visit);
+    }
+
+    /**
+     * @brief search_ranked() split across @p workers threads (0 = all cores).
+     *
+     * Returns exactly what search_ranked() returns.
+     */
+    std::vector<std::string> search_ranked_parallel(
+        std::string_view query,
+        std::size_t limit = 10,
+        std::size_t workers = 0) const
+    {
+      return search_ranked_parallel(query, limit, workers, detail::ThreadExecutor{});
+    }
+
+    /**
+     * @brief search_ranked() split across @p workers tasks run by @p executor.
+     *
+     * The trie is cut into subtree work units that workers claim from a shared
+     * counter, so a worker that finishes early takes over the remaining units.
+     * Each worker keeps a bounded heap of its best @p limit candidates. The caller
+     * merges them in the same score-then-lexicographic order, so results are
+     * deterministic.
+     *
+     * @p executor is called as `executor(n, task)` and must run task(i) for every
+     * i in [0, n) before returning (see detail/parallel.hpp). The read side of the
+     * trie is held by the calling thread for the whole query.
+     */
+    template <typename Executor>
+    std::vector<std::string> search_ranked_parallel(
+        std::string_view query,
+        std::size_t limit,
+        std::size_t workers,
+        Executor &&executor) const
+    {
+      detail::ScopedOperation measure(Operation::search_ranked);
+      ReadLock lock(*this);
+
+      workers = detail::worker_count(workers);
+      const std::vector<WorkUnit> units = split_work(lock.root(), workers * 8);
+      workers = std::max<std::size_t>(1, std::min(workers, units.size()));
+
+      std::vector<detail::QueryScratch> partial(workers);
+      std::atomic<std::size_t> next{0};
+
+      executor(workers, [&](std::size_t w)
+               {
+        detail::QueryScratch &sc = partial[w];
+        sc.reset(limit);
+        detail::prepare_distance(sc, query);
+        for (std::size_t i = next.fetch_add(1); i < units.size(); i = next.fetch_add(1))
+        {
+          const WorkUnit &unit = units[i];
+          sc.key.assign(unit.key);
+          if (unit.whole_subtree)
+          {
+            collect_scored(unit.node, sc, query);
+          }
+          else
+          {
+            const int d = detail::levenshtein_distance(query, sc.key, sc);
+            detail::push_scored(sc, detail::score_distance(d, sc.key.size(), unit.node->frequency));
+          }
+        } });
+
+      detail::QueryScratch merged;
+      for (detail::QueryScratch &sc : partial)
+      {
+        for (std::size_t i = 0; i < sc.scored_size; ++i)
+        {
+          merged.scored.push_back(std::move(sc.scored[i]));
+        }
+      }
+      merged.scored_size = merged.scored.size();
+
+      std::vector<std::string> out;
+      const auto append = [&out](std::string_view word)
+      { out.emplace_back(word); };
+      detail::emit_ranked(merged, limit, append);
+      return out;
+    }
+
+    /**
+     * @brief Ranked fuzzy search bounded by an edit distance.
+     *
+     * Walks the trie with one Levenshtein DP row per depth. Shared prefixes reuse
+     * the parent's row, and a subtree is pruned as soon as the row minimum exceeds
+     * @p max_distance. Cost depends on the number of reachable nodes, not on the
+     * vocabulary size.
+     *
+     * Results are ranked with the same scoring as search_ranked().
+     *
+     * @param query Query string.
+     * @param max_distance Max Levenshtein distance between query and a result.
+     * @param limit Max number of results. If 0, returns all matches.
+     */
+    std::vector<std::string> search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit = 10) const
+    {
+      QueryContext ctx;
+      std::vector<std::string> out;
+      search_fuzzy(query, max_distance, limit, ctx, [&out](std::string_view word)
+                   { out.emplace_back(word); });
+      return out;
+    }
+
+    /**
+     * @brief Visit bounded fuzzy search results, best first.
+     * @return Number of words visited.
+     */
+    template <typename Visitor>
+    std::size_t search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit,
+        Visitor &&visit) const
+    {
+      QueryContext ctx;
+      return search_fuzzy(query, max_distance, limit, ctx, visit);
+    }
+
+    /**
+     * @brief Visit bounded fuzzy search results using the buffers of @p ctx.
+     */
+    template <typename Visitor>
+    std::size_t search_fuzzy(
+        std::string_view query,
+        std::size_t max_distance,
+        std::size_t limit,
+        QueryContext &ctx,
+        Visitor &&visit) const
+    {
+      detail::ScopedOperation measure(Operation::search_fuzzy);
+      ReadLock lock(*this);
+      if (const FlatTrieView *view = lock.frozen())
+      {
+        return view->search_fuzzy(query, max_distance, limit, ctx, visit);
+      }
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+
+      sc.reset(limit);
+      collect_fuzzy_from_root(lock.root(), sc, query, max_distance);
+
+      return detail::emit_ranked(sc, limit, visit);
+    }
+
+    /**
+     * @brief Serialize the trie into a flat image (see flat_trie.hpp).
+     *
+     * Nodes get 32-bit child indices, their children blocks placed in @p layout
+     * order. The image can be queried in place through FlatTrieView or saved and
+     * memory-mapped with MappedTrie.
+     */
+    std::vector<std::byte> to_flat(flat::Layout layout = flat::Layout::breadth_first) const
+    {
+      ReadLock lock(*this);
+      return flat::flatten(lock.root(), layout);
+    }
+
+    /**
+     * @brief Answer reads from a flat, hot-path ordered copy of the trie until the next write.
+     *
+     * Builds a flat::Layout::hot_path image: 24-byte nodes with 32-bit child
+     * indices, each node's children in one block placed right after the block
+     * of its parent, hottest child first. contains(), contains_many(),
+     * frequency(), suggest(), suggest_top(), search_ranked() and search_fuzzy()
+     * then walk that array instead of the arena nodes, with the same results.
+     * Cursors, suggest_after(), suggest_many(), search_ranked_parallel() and
+     * ShardedTrie fan-out keep using the nodes.
+     *
+     * Any write, shrink_to_fit() included, drops the image first; call freeze()
+     * again once a batch of writes is done. Costs one walk of the trie under
+     * the write lock.
+     */
+    void freeze()
+    {
+      WriteLock lock(*this);
+      auto frozen = std::make_unique<Frozen>(flat::flatten(root_.load(std::memory_order_relaxed), flat::Layout::hot_path));
+      frozen_.store(frozen.release(), std::memory_order_release);
+    }
+
+    /**
+     * @brief true between freeze() and the next write.
+     */
+    bool frozen() const noexcept { return frozen_.load(std::memory_order_acquire) != nullptr; }
+
+    /**
+     * @brief Write the flat image to @p out.
+     */
+    void save(std::ostream &out) const
+    {
+      const std::vector<std::byte> image = to_flat();
+      out.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+    }
+
+    /**
+     * @brief Node and terminal counts, bytes by category, fan-out and depth histograms.
+     *
+     * Walks every node under the read lock.
+     */
+    TrieStats stats() const
+    {
+      ReadLock lock(*this);
+      TrieStats s;
+      std::vector<std::pair<const TrieNode *, std::size_t>> stack{{lock.root(), 0}};
+      while (!stack.empty())
+      {
+        const auto [node, depth] = stack.back();
+        stack.pop_back();
+        detail::record_node(s, *node, depth);
+        for (const auto &kv : node->children)
+        {
+          stack.emplace_back(kv.second, depth + 1);
+        }
+      }
+
+      // Snapshot writers grow the arena while readers run; take their mutex.
+      if (concurrency_ == Concurrency::snapshot)
+      {
+        std::lock_guard<std::mutex> writer(mtx_);
+        s.reserved_bytes = arena_.reserved_bytes();
+      }
+      else
+      {
+        s.reserved_bytes = arena_.reserved_bytes();
+      }
+      return s;
+    }
+
+    /**
+     * @brief Rebuild every node with an exactly sized child block, e.g. after ingestion.
+     *
+     * Inserts grow child blocks by doubling and erases leave freed blocks on the
+     * arena's free lists. This copies the trie into a fresh arena, siblings side
+     * by side, and releases the old chunks to the memory resource. Snapshot mode
+     * copies into the live arena and retires the old nodes instead, since readers
+     * may still be on them: the slack then goes to the free lists for reuse.
+     *
+     * Open cursors notice the new generation and rebuild their path.
+     */
+    void shrink_to_fit()
+    {
+      WriteLock lock(*this);
+      TrieNode *old_root = root_.load(std::memory_order_relaxed);
+
+      if (concurrency_ != Concurrency::snapshot)
+      {
+        detail::Arena fresh(arena_.resource());
+        TrieNode *root = copy_compact(old_root, fresh);
+        arena_.swap(fresh);
+        root_.store(root, std::memory_order_release);
+        generation_.fetch_add(1);
+        return;
+      }
+
+      TrieNode *root = copy_compact(old_root, arena_);
+      root_.store(root, std::memory_order_release);
+      generation_.fetch_add(1);
+      retire_subtree(old_root);
+      epoch_->collect(arena_);
+    }
+
+  private:
+    /**
+     * @brief Flat image made by freeze(), and the view reading it.
+     */
+    struct Frozen final
+    {
+      explicit Frozen(std::vector<std::byte> bytes)
+          : image(std::move(bytes)),
+            view(image)
+      {
+      }
+
+      std::vector<std::byte> image;
+      FlatTrieView view;
+    };
+
+    /**
+     * @brief Read access for the configured locking mode.
+     *
+     * Takes the shared lock in Concurrency::shared mode, the mutex in
+     * Concurrency::exclusive mode, and pins an epoch in Concurrency::snapshot
+     * mode. root() is the root to traverse for the lifetime of the guard, and
+     * frozen() the frozen image, if any, that holds the same words.
+     */
+    class ReadLock final
+    {
+    public:
+      explicit ReadLock(const Trie &t)
+          : t_(t)
+      {
+        detail::LockWait wait(t_.concurrency_ != Concurrency::none);
+        if (t_.concurrency_ == Concurrency::shared)
+        {
+          t_.rw_->lock_shared();
+        }
+        else if (t_.concurrency_ == Concurrency::exclusive)
+        {
+          t_.mtx_.lock();
+        }
+        else if (t_.concurrency_ == Concurrency::snapshot)
+        {
+          pin_.emplace(*t_.epoch_);
+        }
+        root_ = t_.root_.load(std::memory_order_acquire);
+        frozen_ = t_.frozen_.load(std::memory_order_acquire);
+      }
+
+      ~ReadLock()
+      {
+        if (t_.concurrency_ == Concurrency::shared)
+        {
+          t_.rw_->unlock_shared();
+        }
+        else if (t_.concurrency_ == Concurrency::exclusive)
+        {
+          t_.mtx_.unlock();
+        }
+      }
+
+      ReadLock(const ReadLock &) = delete;
+      ReadLock &operator=(const ReadLock &) = delete;
+
+      const TrieNode *root() const noexcept { return root_; }
+      const FlatTrieView *frozen() const noexcept { return frozen_ ? &frozen_->view : nullptr; }
+
+    private:
+      const Trie &t_;
+      std::optional<detail::EpochDomain::Pin> pin_{};
+      const TrieNode *root_{nullptr};
+      const Frozen *frozen_{nullptr};
+    };
+
+    /**
+     * @brief Exclusive access in every locking mode. Snapshot writers share the mutex.
+     *
+     * Drops the frozen image, so the guarded code may change the nodes.
+     */
+    class WriteLock final
+    {
+    public:
+      explicit WriteLock(Trie &t)
+          : t_(t)
+      {
+        {
+          detail::LockWait wait(t_.concurrency_ != Concurrency::none);
+          if (t_.concurrency_ == Concurrency::shared)
+          {
+            t_.rw_->lock();
+          }
+          else if (t_.concurrency_ != Concurrency::none)
+          {
+            t_.mtx_.lock();
+          }
+        }
+
+        try
+        {
+          t_.thaw();
+        }
+        catch (...)
+        {
+          unlock();
+          throw;
+        }
+      }
+
+      ~WriteLock()
+      {
+        unlock();
+      }
+
+      WriteLock(const WriteLock &) = delete;
+      WriteLock &operator=(const WriteLock &) = delete;
+
+    private:
+      void unlock() noexcept
+      {
+        if (t_.concurrency_ == Concurrency::shared)
+        {
+          t_.rw_->unlock();
+        }
+        else if (t_.concurrency_ != Concurrency::none)
+        {
+          t_.mtx_.unlock();
+        }
+      }
+
+      Trie &t_;
+    };
+
+    /**
+     * @brief Drop the frozen image. Needs the write lock.
+     *
+     * Readers of a snapshot trie may still be on it, so there it is retired
+     * to the epoch domain like a node.
+     */
+    void thaw()
+    {
+      Frozen *frozen = frozen_.load(std::memory_order_relaxed);
+      if (!frozen)
+      {
+        return;
+      }
+      if (concurrency_ == Concurrency::snapshot)
+      {
+        epoch_->retire(frozen, [](void *p)
+                       { delete static_cast<Frozen *>(p); });
+      }
+      frozen_.store(nullptr, std::memory_order_release);
+      if (concurrency_ != Concurrency::snapshot)
+      {
+        delete frozen;
+      }
+    }
+
+    /**
+     * @brief Walk every key from @p root and call `done(i, node)` with the node of
+     *        keys[i], or nullptr if the trie has no such path.
+     *
+     * Keys advance one byte per round in groups of batch_width. The child found
+     * for a key is prefetched and not touched again until the rest of its group
+     * has stepped, which hides most of the miss latency.
+     */
+    template <typename Done>
+    static void locate_many(const TrieNode *root, std::span<const std::string_view> keys, Done &&done)
+    {
+      constexpr std::size_t batch_width = 8;
+
+      for (std::size_t base = 0; base < keys.size(); base += batch_width)
+      {
+        const std::size_t n = std::min(batch_width, keys.size() - base);
+        const TrieNode *node[batch_width];
+        std::size_t active = 0;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+          node[k] = root;
+          active += keys[base + k].empty() ? 0 : 1;
+        }
+
+        for (std::size_t depth = 0; active != 0; ++depth)
+        {
+          for (std::size_t k = 0; k < n; ++k)
+          {
+            const std::string_view key = keys[base + k];
+            if (!node[k] || depth >= key.size())
+            {
+              continue;
+            }
+
+            detail::count_nodes(1);
+            node[k] = node[k]->children.find(key[depth]);
+            if (node[k])
+            {
+              detail::prefetch(node[k]);
+            }
+            if (!node[k] || depth + 1 == key.size())
+            {
+              --active;
+            }
+          }
+        }
+
+        for (std::size_t k = 0; k < n; ++k)
+        {
+          done(base + k, node[k]);
+        }
+      }
+    }
+
+    /**
+     * @brief A subtree root for best_completions(): its node, key and edit distance.
+     */
+    struct Seed final
+    {
+      const TrieNode *node;
+      std::string_view key;
+      std::uint32_t distance;
+    };
+
+    /**
+     * @brief Best-first completions of several subtrees.
+     *
+     * Words pop in (distance asc, frequency desc, word asc) order, guided by the
+     * cached max_frequency of each subtree. When seeds overlap, a word is only
+     * returned for its first, smallest-distance occurrence.
+     */
+    static std::vector<std::string> best_completions(std::span<const Seed> seeds, std::size_t k)
+    {
+      struct Entry final
+      {
+        std::uint32_t distance;
+        Frequency bound;
+        bool is_word;
+        const TrieNode *node;
+        std::string key;
+      };
+
+      // Pops in (distance asc, bound desc, key asc) order.
+      const auto worse = [](const Entry &a, const Entry &b)
+      {
+        if (a.distance != b.distance)
+          return a.distance > b.distance;
+        if (a.bound != b.bound)
+          return a.bound < b.bound;
+        return a.key > b.key;
+      };
+
+      std::priority_queue<Entry, std::vector<Entry>, decltype(worse)> frontier(worse);
+      std::vector<std::string> out;
+      std::set<std::string, std::less<>> emitted;
+
+      // Zero-frequency subtrees are walked too: insert(word, 0) still makes a word.
+      for (const Seed &seed : seeds)
+      {
+        frontier.push(Entry{seed.distance, seed.node->max_frequency, false, seed.node, std::string(seed.key)});
+      }
+
+      while (!frontier.empty() && (k == 0 || out.size() < k))
+      {
+        Entry top = frontier.top();
+        frontier.pop();
+
+        if (top.is_word)
+        {
+          if (seeds.size() == 1 || emitted.insert(top.key).second)
+          {
+            out.push_back(std::move(top.key));
+          }
+          continue;
+        }
+
+        detail::count_nodes(1);
+        if (top.node->is_terminal)
+        {
+          frontier.push(Entry{top.distance, top.node->frequency, true, nullptr, top.key});
+        }
+
+        for (const auto &kv : top.node->children)
+        {
+          std::string key = top.key;
+          key.push_back(kv.first);
+          frontier.push(Entry{top.distance, kv.second->max_frequency, false, kv.second, std::move(key)});
+        }
+      }
+
+      return out;
+    }
+
+    /**
+     * @brief A subtree, or a single terminal when whole_subtree is false.
+     */
+    struct WorkUnit final
+    {
+      const TrieNode *node;
+      std::string key;
+      bool whole_subtree;
+    };
+
+    /**
+     * @brief Cut the trie under @p root into at least @p target units where possible.
+     *
+     * Expands subtrees breadth-first. An expanded node leaves a single-terminal
+     * unit behind if it ends a word, so every word is in exactly one unit.
+     */
+    static std::vector<WorkUnit> split_work(const TrieNode *root, std::size_t target)
+    {
+      std::vector<WorkUnit> units;
+      units.push_back(WorkUnit{root, std::string(), true});
+
+      for (std::size_t i = 0; i < units.size() && units.size() < target; ++i)
+      {
+        if (!units[i].whole_subtree || units[i].node->children.empty())
+        {
+          continue;
+        }
+
+        const TrieNode *node = units[i].node;
+        const std::string key = units[i].key;
+        units[i].whole_subtree = false;
+
+        for (const auto &kv : node->children)
+        {
+          units.push_back(WorkUnit{kv.second, key + kv.first, true});
+        }
+      }
+
+      units.erase(std::remove_if(units.begin(), units.end(), [](const WorkUnit &u)
+                                 { return !u.whole_subtree && !u.node->is_terminal; }),
+                  units.end());
+      return units;
+    }
+
+    /**
+     * @brief Insert @p word or raise its frequency by @p weight. Caller holds the write lock.
+     */
+    void add_weight(std::string_view word, Frequency weight)
+    {
+      if (concurrency_ == Concurrency::snapshot)
+      {
+        insert_path_copy(word, weight);
+        return;
+      }
+
+      TrieNode *node = root_.load(std::memory_order_relaxed);
+      for (char c : word)
+      {
+        detail::count_nodes(1);
+        TrieNode *next = node->children.find(c);
+        if (!next)
+        {
+          next = arena_.create<TrieNode>();
+          node->children.emplace(c, next, arena_);
+        }
+        node = next;
+      }
+
+      node->is_terminal = true;
+      node->frequency = detail::saturating_add(node->frequency, weight);
+      raise_max_frequency(root_.load(std::memory_order_relaxed), word, node->frequency);
+      generation_.fetch_add(1);
+    }
+
+    /**
+     * @brief Apply sorted, unique @p entries in one walk. Caller holds the write lock.
+     *
+     * The stack holds the previous word's path. In snapshot mode every node on
+     * it is a private copy: sorted input never returns to a subtree it has
+     * left, so a child found below the stack is always an original to clone.
+     */
+    void merge_sorted(const std::vector<detail::SortedEntry> &entries)
+    {
+      const bool snapshot = concurrency_ == Concurrency::snapshot;
+      TrieNode *old_root = root_.load(std::memory_order_relaxed);
+
+      std::vector<TrieNode *> replaced;
+      std::vector<TrieNode *> path;
+      path.push_back(snapshot ? clone_node(old_root) : old_root);
+      if (snapshot)
+      {
+        replaced.push_back(old_root);
+      }
+
+      std::string_view previous;
+      for (const detail::SortedEntry &e : entries)
+      {
+        const std::size_t n = std::min(previous.size(), e.word.size());
+        std::size_t common = 0;
+        while (common < n && previous[common] == e.word[common])
+        {
+          ++common;
+        }
+        path.resize(common + 1);
+
+        for (std::size_t i = common; i < e.word.size(); ++i)
+        {
+          TrieNode *parent = path.back();
+          detail::count_nodes(1);
+          TrieNode *child = parent->children.find(e.word[i]);
+          if (!child)
+          {
+            child = arena_.create<TrieNode>();
+            parent->children.emplace(e.word[i], child, arena_);
+          }
+          else if (snapshot)
+          {
+            replaced.push_back(child);
+            child = clone_node(child);
+            parent->children.replace(e.word[i], child);
+          }
+          path.push_back(child);
+        }
+
+        TrieNode *node = path.back();
+        node->is_terminal = true;
+        node->frequency = detail::saturating_add(node->frequency, e.frequency);
+        for (TrieNode *on_path : path)
+        {
+          on_path->max_frequency = std::max(on_path->max_frequency, node->frequency);
+        }
+        previous = e.word;
+      }
+
+      if (!snapshot)
+      {
+        generation_.fetch_add(1);
+        return;
+      }
+
+      root_.store(path.front(), std::memory_order_release);
+      generation_.fetch_add(1);
+      for (TrieNode *n : replaced)
+      {
+        retire_node(n);
+      }
+      epoch_->collect(arena_);
+    }
+
+    /**
+     * @brief Node of @p word if it is a word of the trie, else nullptr. Caller holds the write lock.
+     */
+    const TrieNode *find_terminal(std::string_view word) const noexcept
+    {
+      const TrieNode *node = root_.load(std::memory_order_relaxed);
+      for (char c : word)
+      {
+        detail::count_nodes(1);
+        node = node->children.find(c);
+        if (!node)
+        {
+          return nullptr;
+        }
+      }
+      return node->is_terminal ? node : nullptr;
+    }
+
+    /**
+     * @brief Set the frequency of the present word @p word to @p frequency, erasing it at 0.
+     *
+     * Caller holds the write lock. Snapshot mode path-copies as insert() does;
+     * the other modes update the path in place and free pruned nodes at once.
+     */
+    void lower_frequency(std::string_view word, Frequency frequency)
+    {
+      std::vector<TrieNode *> path;
+      path.reserve(word.size() + 1);
+
+      TrieNode *old = root_.load(std::memory_order_relaxed);
+      const bool snapshot = concurrency_ == Concurrency::snapshot;
+      path.push_back(snapshot ? clone_node(old) : old);
+
+      std::vector<TrieNode *> replaced;
+      if (snapshot)
+      {
+        replaced.reserve(word.size() + 1);
+        replaced.push_back(old);
+      }
+
+      for (char c : word)
+      {
+        old = old->children.find(c);
+        if (snapshot)
+        {
+          TrieNode *child = clone_node(old);
+          path.back()->children.replace(c, child);
+          replaced.push_back(old);
+          path.push_back(child);
+        }
+        else
+        {
+          path.push_back(old);
+        }
+      }
+
+      TrieNode *node = path.back();
+      node->frequency = frequency;
+      node->is_terminal = frequency != 0;
+      prune_path(path, word);
+
+      if (snapshot)
+      {
+        root_.store(path.front(), std::memory_order_release);
+        generation_.fetch_add(1);
+        for (TrieNode *n : replaced)
+        {
+          retire_node(n);
+        }
+        epoch_->collect(arena_);
+      }
+      else
+      {
+        generation_.fetch_add(1);
+      }
+    }
+
+    /**
+     * @brief Walk @p path (root first, one node per byte of @p word) bottom-up,
+     *        unlinking nodes that hold no word and refreshing max_frequency.
+     *
+     * Unlinked nodes must be unreachable by readers: in snapshot mode the path
+     * is a private copy.
+     */
+    void prune_path(const std::vector<TrieNode *> &path, std::string_view word)
+    {
+      for (std::size_t i = path.size(); i-- > 1;)
+      {
+        TrieNode *n = path[i];
+        if (!n->is_terminal && n->children.empty())
+        {
+          path[i - 1]->children.erase(word[i - 1], arena_);
+          arena_.destroy(n);
+          continue;
+        }
+        n->max_frequency = subtree_max_frequency(n);
+      }
+      path.front()->max_frequency = subtree_max_frequency(path.front());
+    }
+
+    static Frequency subtree_max_frequency(const TrieNode *n) noexcept
+    {
+      Frequency best = n->is_terminal ? n->frequency : 0;
+      for (const auto &kv : n->children)
+      {
+        best = std::max(best, kv.second->max_frequency);
+      }
+      return best;
+    }
+
+    /**
+     * @brief Snapshot-mode insert: copy the path, publish the new root, retire the old path.
+     *
+     * Reachable nodes are never written, so pinned readers keep a consistent view.
+     */
+    void insert_path_copy(std::string_view word, Frequency weight)
+    {
+      std::vector<TrieNode *> replaced;
+      replaced.reserve(word.size() + 1);
+
+      TrieNode *old = root_.load(std::memory_order_relaxed);
+      TrieNode *copy = clone_node(old);
+      TrieNode *new_root = copy;
+      replaced.push_back(old);
+
+      for (char c : word)
+      {
+        detail::count_nodes(1);
+        TrieNode *old_child = old ? old->children.find(c) : nullptr;
+        if (old_child)
+        {
+          TrieNode *child = clone_node(old_child);
+          copy->children.replace(c, child);
+          replaced.push_back(old_child);
+          copy = child;
+        }
+        else
+        {
+          TrieNode *child = arena_.create<TrieNode>();
+          copy->children.emplace(c, child, arena_);
+          copy = child;
+        }
+        old = old_child;
+      }
+
+      copy->is_terminal = true;
+      copy->frequency = detail::saturating_add(copy->frequency, weight);
+      raise_max_frequency(new_root, word, copy->frequency);
+
+      root_.store(new_root, std::memory_order_release);
+      generation_.fetch_add(1);
+
+      for (TrieNode *n : replaced)
+      {
+        retire_node(n);
+      }
+      epoch_->collect(arena_);
+    }
+
+    /**
+     * @brief Raise max_frequency on the path of @p word to at least @p frequency.
+     */
+    static void raise_max_frequency(TrieNode *node, std::string_view word, Frequency frequency)
+    {
+      node->max_frequency = std::max(node->max_frequency, frequency);
+      for (char c : word)
+      {
+        node = node->children.find(c);
+        node->max_frequency = std::max(node->max_frequency, frequency);
+      }
+    }
+
+    TrieNode *clone_node(const TrieNode *src)
+    {
+      TrieNode *n = arena_.create<TrieNode>();
+      n->children.copy_from(src->children, arena_);
+      n->is_terminal = src->is_terminal;
+      n->frequency = src->frequency;
+      n->max_frequency = src->max_frequency;
+      return n;
+    }
+
+    void retire_node(TrieNode *n)
+    {
+      if (void *block = n->children.storage())
+      {
+        epoch_->retire(block, n->children.storage_bytes());
+      }
+      epoch_->retire(n, sizeof(TrieNode));
+    }
+
+    void retire_subtree(TrieNode *root)
+    {
+      std::vector<TrieNode *> stack{root};
+      while (!stack.empty())
+      {
+        TrieNode *n = stack.back();
+        stack.pop_back();
+        for (const auto &kv : n->children)
+        {
+          stack.push_back(kv.second);
+        }
+        retire_node(n);
+      }
+    }
+
+    /**
+     * @brief Copy the nodes below @p src into @p arena, each child block exactly sized.
+     */
+    static TrieNode *copy_compact(const TrieNode *src, detail::Arena &arena)
+    {
+      std::vector<std::pair<const TrieNode *, TrieNode *>> stack;
+      std::vector<typename detail::ChildMap<TrieNode>::value_type> children;
+
+      TrieNode *root = arena.create<TrieNode>();
+      stack.emplace_back(src, root);
+      while (!stack.empty())
+      {
+        const auto [from, to] = stack.back();
+        stack.pop_back();
+        to->is_terminal = from->is_terminal;
+        to->frequency = from->frequency;
+        to->max_frequency = from->max_frequency;
+
+        children.clear();
+        for (const auto &kv : from->children)
+        {
+          TrieNode *child = arena.create<TrieNode>();
+          children.emplace_back(kv.first, child);
+          stack.emplace_back(kv.second, child);
+        }
+        to->children.assign_sorted(children.data(), children.size(), arena);
+      }
+      return root;
+    }
+
+    /**
+     * @brief Visit the words below @p start in byte order; sc.key holds its key.
+     *
+     * Iterative preorder walk on sc.stack. Returns false once the query must
+     * stop. sc.key is restored before returning.
+     */
+    template <typename Visitor>
+    static bool collect_suggestions(
+        const TrieNode *start,
+        detail::QueryScratch &sc,
+        std::size_t limit,
+        std::size_t &count,
+        Visitor &visit)
+    {
+      const std::size_t base = sc.key.size();
+      sc.stack.clear();
+      detail::count_nodes(1);
+      const bool more = walk_suggestions(start, sc, limit, count, visit);
+      sc.key.resize(base);
+      return more;
+    }
+
+    /**
+     * @brief Visit @p first, then every node left on sc.stack, in preorder.
+     *
+     * @p first must be keyed by sc.key (or be nullptr). Returns false once the
+     * query must stop.
+     */
+    template <typename Visitor>
+    static bool walk_suggestions(
+        const TrieNode *first,
+        detail::QueryScratch &sc,
+        std::size_t limit,
+        std::size_t &count,
+        Visitor &visit)
+    {
+      for (const TrieNode *node = first; node; node = next_frame(sc))
+      {
+        if (node->is_terminal)
+        {
+          ++count;
+          if (!detail::emit(visit, sc.key) || (limit != 0 && count >= limit))
+          {
+            return false;
+          }
+        }
+        push_children(sc, node);
+      }
+      return true;
+    }
+
+    /**
+     * @brief Offer every word below @p start to @p sc; sc.key holds its key.
+     */
+    static void collect_scored(
+        const TrieNode *start,
+        detail::QueryScratch &sc,
+        std::string_view query)
+    {
+      const std::size_t base = sc.key.size();
+      sc.stack.clear();
+      detail::count_nodes(1);
+
+      for (const TrieNode *node = start; node; node = next_frame(sc))
+      {
+        if (node->is_terminal)
+        {
+          const int d = detail::levenshtein_distance(query, sc.key, sc);
+          detail::push_scored(sc, detail::score_distance(d, sc.key.size(), node->frequency));
+        }
+        push_children(sc, node);
+      }
+
+      sc.key.resize(base);
+    }
+
+    /**
+     * @brief Offer every word of the trie at @p root within @p max_distance of @p query to @p sc.
+     *
+     * One Levenshtein DP row per depth: the row of a node is computed from its
+     * parent's, and a subtree is skipped as soon as the row minimum exceeds
+     * @p max_distance. sc.key must be empty.
+     */
+    static void collect_fuzzy_from_root(
+        const TrieNode *root,
+        detail::QueryScratch &sc,
+        std::string_view query,
+        std::size_t max_distance)
+    {
+      const std::size_t width = query.size() + 1;
+      const int bound = detail::distance_bound(max_distance);
+
+      // rows[d * width .. (d + 1) * width) holds the DP row at depth d.
+      std::vector<int> &rows = sc.rows;
+      rows.resize(width);
+      for (std::size_t j = 0; j < width; ++j)
+      {
+        rows[j] = static_cast<int>(j);
+      }
+
+      if (root->is_terminal && query.size() <= max_distance)
+      {
+        detail::push_scored(sc, detail::score_distance(static_cast<int>(query.size()), 0, root->frequency));
+      }
+
+      sc.stack.clear();
+      detail::count_nodes(1);
+      push_children(sc, root);
+      while (const TrieNode *node = next_frame(sc))
+      {
+        const std::size_t depth = sc.key.size();
+        rows.resize((depth + 1) * width);
+        int *row = rows.data() + depth * width;
+        const int row_min = detail::levenshtein_step(query, row - width, row, sc.key.back());
+
+        if (node->is_terminal && row[width - 1] <= bound)
+        {
+          detail::push_scored(sc, detail::score_distance(row[width - 1], depth, node->frequency));
+        }
+        if (row_min <= bound)
+        {
+          push_children(sc, node);
+        }
+      }
+
+      sc.key.clear();
+    }
+
+    /**
+     * @brief Queue the children of @p node, keyed after sc.key, to pop in byte order.
+     */
+    static void push_children(detail::QueryScratch &sc, const TrieNode *node)
+    {
+      const std::size_t mark = sc.stack.size();
+      const auto key_size = static_cast<std::uint32_t>(sc.key.size());
+      for (const auto &kv : node->children)
+      {
+        sc.stack.push_back(detail::Frame{reinterpret_cast<std::uintptr_t>(kv.second),
+                                         key_size,
+                                         static_cast<unsigned char>(kv.first)});
+      }
+      std::reverse(sc.stack.begin() + static_cast<std::ptrdiff_t>(mark), sc.stack.end());
+    }
+
+    /**
+     * @brief Pop the next node of the walk and set sc.key to its key, or return nullptr.
+     */
+    static const TrieNode *next_frame(detail::QueryScratch &sc)
+    {
+      if (sc.stack.empty())
       {
-        current.push_back(kv.first);
-        collect_scored(kv.second.get(), current, out, query);
-        current.pop_back();
+        return nullptr;
       }
+      const detail::Frame f = sc.stack.back();
+      sc.stack.pop_back();
+      detail::count_nodes(1);
+      sc.key.resize(f.key_size);
+      sc.key.push_back(static_cast<char>(f.aux));
+      return reinterpret_cast<const TrieNode *>(f.node);
     }
 
   private:
-    std::unique_ptr<TrieNode> root_;
-    bool thread_safe_{false};
+    detail::Arena arena_;
+    std::atomic<TrieNode *> root_;
+    Concurrency concurrency_{Concurrency::none};
     mutable std::mutex mtx_;
+    std::unique_ptr<detail::ReaderWriterLock> rw_;
+    std::unique_ptr<detail::EpochDomain> epoch_;
+    /// Bumped by every mutation, after a new snapshot root is published and
+    /// before anything is retired. Lets a Cursor detect that its nodes are stale.
+    std::atomic<std::uint64_t> generation_{0};
+    /// Set by freeze(), cleared by the next write.
+    std::atomic<Frozen *> frozen_{nullptr};
   };
 
 } // namespace trie
@@ -0,0 +1,590 @@
+/**
+ * @file trie_loader.hpp
+ * @brief Streaming word list loader and a handle that swaps in reloaded tries.
+ *
+ * Notes:
+ * - A word list has one entry per line: `word` (count 1) or `word<TAB>count`.
+ *   Blank lines are skipped and a trailing '\r' is dropped.
+ * - TrieLoader reads the list in chunks of a fixed number of lines and merges
+ *   each chunk with merge_counts(), so memory beyond the trie is one chunk.
+ *   With several workers, each chunk is split by first byte and handed to
+ *   persistent worker threads, one per partition, which merge it into private
+ *   tries while the next chunk is read (two chunks in memory). The result
+ *   then takes over the partitions' nodes without copying them.
+ * - TrieHandle publishes immutable tries through an atomic shared_ptr. Readers
+ *   take a reference and query it without locks; reload() builds the next
+ *   trie on a background thread and swaps it in. When the last reader drops
+ *   a reloaded trie, it is queued to a reaper thread and destroyed there, so
+ *   teardown never lands on a query.
+ */
+
+#ifndef TRIE_TRIE_LOADER_HPP
+#define TRIE_TRIE_LOADER_HPP
+
+#include <trie/detail/arena.hpp>
+#include <trie/trie.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace trie
+{
+  /**
+   * @brief How TrieLoader builds a trie.
+   */
+  struct LoadOptions final
+  {
+    /// Lines read and merged at a time.
+    std::size_t chunk_lines{1u << 16};
+    /// First-byte partitions built in parallel. 1 builds in place, 0 uses every core.
+    std::size_t workers{1};
+    /// Locking mode of the result. Tries published through a TrieHandle are
+    /// never written again, so none is enough for concurrent readers.
+    Concurrency concurrency{Concurrency::none};
+    /// Call freeze() on the result.
+    bool freeze{false};
+    /// Upstream memory resource of the result. Workers allocate from it under
+    /// a lock, so it need not be thread-safe even with several workers.
+    std::pmr::memory_resource *resource{std::pmr::get_default_resource()};
+  };
+
+  /**
+   * @brief Builds a Trie from a word list stream or file.
+   *
+   * Throws std::invalid_argument on a malformed count and std::system_error if
+   * a file cannot be opened or a stream fails to read.
+   */
+  class TrieLoader final
+  {
+  public:
+    explicit TrieLoader(LoadOptions options = {})
+        : options_(options)
+    {
+      if (options_.chunk_lines == 0)
+      {
+        options_.chunk_lines = 1;
+      }
+      if (options_.workers == 0)
+      {
+        options_.workers = std::max(1u, std::thread::hardware_concurrency());
+      }
+    }
+
+    std::shared_ptr<Trie> load(std::istream &in) const
+    {
+      auto t = std::make_shared<Trie>(options_.concurrency, options_.resource);
+      const std::size_t parts = options_.workers;
+      std::size_t line_number = 0;
+
+      if (parts == 1)
+      {
+        Chunk chunk;
+        while (read_chunk(in, chunk, line_number))
+        {
+          t->merge_counts(chunk.entries());
+        }
+      }
+      else
+      {
+        // Partitions grow on several threads at once, so their arenas share
+        // options_.resource through a lock; graft() then adopts their chunks.
+        detail::LockedResource shared(options_.resource);
+        std::vector<std::unique_ptr<Trie>> partitions;
+        for (std::size_t i = 0; i < parts; ++i)
+        {
+          partitions.push_back(std::make_unique<Trie>(Concurrency::none, &shared));
+        }
+
+        {
+          // Chunk n is read into chunks[n % 2] while chunk n - 1 merges.
+          Chunk chunks[2];
+          std::vector<std::vector<Entry>> buckets[2] = {std::vector<std::vector<Entry>>(parts),
+                                                        std::vector<std::vector<Entry>>(parts)};
+          MergeWorkers workers(partitions);
+          for (std::size_t n = 0; read_chunk(in, chunks[n % 2], line_number); ++n)
+          {
+            std::vector<std::vector<Entry>> &batch = buckets[n % 2];
+            for (std::vector<Entry> &b : batch)
+            {
+              b.clear();
+            }
+            for (const Entry &e : chunks[n % 2].entries())
+            {
+              const std::size_t i = e.first.empty() ? 0 : static_cast<unsigned char>(e.first[0]) % parts;
+              batch[i].push_back(e);
+            }
+            workers.submit(batch);
+          }
+          workers.finish();
+        }
+
+        graft(*t, partitions);
+      }
+      if (options_.freeze)
+      {
+        t->freeze();
+      }
+      return t;
+    }
+
+    std::shared_ptr<Trie> load(const std::string &path) const
+    {
+      std::ifstream in(path, std::ios::binary);
+      if (!in)
+      {
+        throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "trie: cannot open " + path);
+      }
+      return load(in);
+    }
+
+    const LoadOptions &options() const noexcept { return options_; }
+
+  private:
+    using Entry = std::pair<std::string_view, Frequency>;
+
+    /**
+     * @brief The lines of one read, in a single buffer.
+     */
+    struct Chunk final
+    {
+      struct Span final
+      {
+        std::size_t offset;
+        std::size_t size;
+        Frequency count;
+      };
+
+      std::string bytes;
+      std::vector<Span> spans;
+      std::vector<Entry> views;
+
+      const std::vector<Entry> &entries()
+      {
+        views.clear();
+        for (const Span &s : spans)
+        {
+          views.emplace_back(std::string_view(bytes).substr(s.offset, s.size), s.count);
+        }
+        return views;
+      }
+    };
+
+    /**
+     * @brief Read up to chunk_lines entries into @p chunk. Returns false at the end of input.
+     */
+    bool read_chunk(std::istream &in, Chunk &chunk, std::size_t &line_number) const
+    {
+      chunk.bytes.clear();
+      chunk.spans.clear();
+
+      std::string line;
+      while (chunk.spans.size() < options_.chunk_lines && std::getline(in, line))
+      {
+        ++line_number;
+        if (!line.empty() && line.back() == '\r')
+        {
+          line.pop_back();
+        }
+        if (line.empty())
+        {
+          continue;
+        }
+
+        std::string_view word = line;
+        Frequency count = 1;
+        const std::size_t tab = word.rfind('\t');
+        if (tab != std::string_view::npos)
+        {
+          const char *first = word.data() + tab + 1;
+          const char *last = word.data() + word.size();
+          const auto [end, ec] = std::from_chars(first, last, count);
+          if (first == last || ec != std::errc{} || end != last)
+          {
+            throw std::invalid_argument("trie: bad count on line " + std::to_string(line_number));
+          }
+          word = word.substr(0, tab);
+        }
+
+        chunk.spans.push_back(typename Chunk::Span{chunk.bytes.size(), word.size(), count});
+        chunk.bytes.append(word);
+      }
+
+      if (in.bad())
+      {
+        throw std::system_error(std::make_error_code(std::errc::io_error), "trie: word list read failed");
+      }
+      return !chunk.spans.empty();
+    }
+
+    /**
+     * @brief Persistent merge threads, one per partition.
+     *
+     * submit() waits for the previous batch, so the caller reads the next
+     * chunk while the workers merge the current one. The first worker
+     * exception is rethrown by the next submit() or finish().
+     */
+    class MergeWorkers final
+    {
+    public:
+      explicit MergeWorkers(std::vector<std::unique_ptr<Trie>> &partitions)
+          : partitions_(partitions)
+      {
+        threads_.reserve(partitions.size());
+        try
+        {
+          for (std::size_t i = 0; i < partitions.size(); ++i)
+          {
+            threads_.emplace_back([this, i]
+                                  { run(i); });
+          }
+        }
+        catch (...)
+        {
+          stop();
+          throw;
+        }
+      }
+
+      ~MergeWorkers() { stop(); }
+
+      MergeWorkers(const MergeWorkers &) = delete;
+      MergeWorkers &operator=(const MergeWorkers &) = delete;
+
+      /**
+       * @brief Merge @p buckets[i] into partition i. @p buckets must stay untouched until the next submit() or finish().
+       */
+      void submit(const std::vector<std::vector<Entry>> &buckets)
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        wait_idle(lock);
+        batch_ = &buckets;
+        pending_ = partitions_.size();
+        ++sequence_;
+        lock.unlock();
+        work_.notify_all();
+      }
+
+      /**
+       * @brief Wait for the last batch.
+       */
+      void finish()
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        wait_idle(lock);
+      }
+
+    private:
+      void wait_idle(std::unique_lock<std::mutex> &lock)
+      {
+        idle_.wait(lock, [this]
+                   { return pending_ == 0; });
+        if (error_)
+        {
+          std::rethrow_exception(error_);
+        }
+      }
+
+      void run(std::size_t i)
+      {
+        std::uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mtx_);
+        for (;;)
+        {
+          work_.wait(lock, [&]
+                     { return stopping_ || sequence_ != seen; });
+          if (stopping_)
+          {
+            return;
+          }
+          seen = sequence_;
+          const std::vector<Entry> &bucket = (*batch_)[i];
+          lock.unlock();
+
+          std::exception_ptr failure;
+          try
+          {
+            if (!bucket.empty())
+            {
+              partitions_[i]->merge_counts(bucket);
+            }
+          }
+          catch (...)
+          {
+            failure = std::current_exception();
+          }
+
+          lock.lock();
+          if (failure && !error_)
+          {
+            error_ = failure;
+          }
+          if (--pending_ == 0)
+          {
+            idle_.notify_one();
+          }
+        }
+      }
+
+      void stop() noexcept
+      {
+        {
+          std::lock_guard<std::mutex> lock(mtx_);
+          stopping_ = true;
+        }
+        work_.notify_all();
+        for (std::thread &th : threads_)
+        {
+          th.join();
+        }
+        threads_.clear();
+      }
+
+      std::vector<std::unique_ptr<Trie>> &partitions_;
+      std::vector<std::thread> threads_{};
+      std::mutex mtx_;
+      std::condition_variable work_;
+      std::condition_variable idle_;
+      const std::vector<std::vector<Entry>> *batch_{nullptr};
+      std::size_t pending_{0};
+      std::uint64_t sequence_{0};
+      bool stopping_{false};
+      std::exception_ptr error_{};
+    };
+
+    /**
+     * @brief Move the partitions under the root of the empty trie @p into.
+     *
+     * Partitions hold disjoint first bytes, so their root children are simply
+     * unioned. The nodes are not copied: @p into adopts each partition's
+     * arena, whose chunks come from the same upstream resource.
+     */
+    static void graft(Trie &into, std::vector<std::unique_ptr<Trie>> &partitions)
+    {
+      TrieNode *root = into.root_.load(std::memory_order_relaxed);
+      std::vector<typename detail::ChildMap<TrieNode>::value_type> children;
+
+      for (std::unique_ptr<Trie> &part : partitions)
+      {
+        const TrieNode *from = part->root_.load(std::memory_order_relaxed);
+        if (from->is_terminal)
+        {
+          root->is_terminal = true;
+          root->frequency = from->frequency;
+        }
+        root->max_frequency = std::max(root->max_frequency, from->max_frequency);
+        for (const auto &kv : from->children)
+        {
+          children.emplace_back(kv.first, kv.second);
+        }
+        into.arena_.adopt(part->arena_);
+        part.reset();
+      }
+
+      std::sort(children.begin(), children.end(), [](const auto &a, const auto &b)
+                { return static_cast<unsigned char>(a.first) < static_cast<unsigned char>(b.first); });
+      root->children.assign_sorted(children.data(), children.size(), into.arena_);
+      into.generation_.fetch_add(1);
+    }
+
+    LoadOptions options_;
+  };
+
+  /**
+   * @brief Shared, swappable reference to the current read-only Trie.
+   *
+   * Features:
+   * - get(): the current trie, kept alive for as long as the caller holds it
+   * - store(next): publish a trie built elsewhere
+   * - reload(build), reload(path, options): build the next trie on a
+   *   background thread and publish it; wait() joins it
+   * - version(): number of tries published since construction
+   *
+   * Thread safety:
+   * - get(), store() and version() may be called from any thread.
+   * - reload() and wait() must be called by one thread at a time.
+   */
+  class TrieHandle final
+  {
+  public:
+    explicit TrieHandle(std::shared_ptr<const Trie> initial = std::make_shared<const Trie>())
+        : current_(std::move(initial))
+    {
+    }
+
+    /**
+     * @brief Join a running reload and the reaper. A reload exception is
+     *        dropped, and tries still held by readers are destroyed by them.
+     */
+    ~TrieHandle()
+    {
+      if (worker_.joinable())
+      {
+        worker_.join();
+      }
+      reaper_->close();
+      if (reaper_thread_.joinable())
+      {
+        reaper_thread_.join();
+      }
+    }
+
+    TrieHandle(const TrieHandle &) = delete;
+    TrieHandle &operator=(const TrieHandle &) = delete;
+
+    std::shared_ptr<const Trie> get() const noexcept { return current_.load(std::memory_order_acquire); }
+
+    std::uint64_t version() const noexcept { return version_.load(); }
+
+    /**
+     * @brief Publish @p next. Returns the previous trie.
+     */
+    std::shared_ptr<const Trie> store(std::shared_ptr<const Trie> next) noexcept
+    {
+      std::shared_ptr<const Trie> previous = current_.exchange(std::move(next), std::memory_order_acq_rel);
+      version_.fetch_add(1);
+      return previous;
+    }
+
+    /**
+     * @brief Run `build()` on a background thread and publish the trie it returns.
+     *
+     * Waits for the previous reload first and rethrows its exception. While
+     * building, get() keeps returning the current trie. The background thread
+     * finishes with the swap; the published trie is destroyed on the reaper
+     * thread once its last reference is dropped. An exception from @p build
+     * leaves the current trie in place and is rethrown by wait().
+     */
+    template <typename Build>
+    void reload(Build build)
+    {
+      wait();
+      if (!reaper_thread_.joinable())
+      {
+        reaper_thread_ = std::thread([reaper = reaper_]
+                                     { reaper->run(); });
+      }
+      worker_ = std::thread([this, build = std::move(build)]() mutable
+                            {
+        try
+        {
+          std::shared_ptr<const Trie> built(build());
+          const Trie *raw = built.get();
+          store(std::shared_ptr<const Trie>(raw, [reaper = reaper_, built = std::move(built)](const Trie *) mutable
+                                            { reaper->push(std::move(built)); }));
+        }
+        catch (...)
+        {
+          error_ = std::current_exception();
+        } });
+    }
+
+    /**
+     * @brief reload() from the word list at @p path.
+     */
+    void reload(std::string path, LoadOptions options = {})
+    {
+      reload([path = std::move(path), options]
+             { return TrieLoader(options).load(path); });
+    }
+
+    /**
+     * @brief Wait for the running reload, if any. Rethrows its exception.
+     */
+    void wait()
+    {
+      if (worker_.joinable())
+      {
+        worker_.join();
+      }
+      if (error_)
+      {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+      }
+    }
+
+  private:
+    /**
+     * @brief Queue of released tries, destroyed on the reaper thread.
+     *
+     * Shared with the deleters of reloaded tries, which may outlive the
+     * handle. After close(), push() destroys the trie in place.
+     */
+    struct Reaper final
+    {
+      std::mutex mtx;
+      std::condition_variable cv;
+      std::vector<std::shared_ptr<const Trie>> queue;
+      bool closed{false};
+
+      void push(std::shared_ptr<const Trie> trie)
+      {
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          if (!closed)
+          {
+            queue.push_back(std::move(trie));
+            cv.notify_one();
+            return;
+          }
+        }
+        trie.reset();
+      }
+
+      void close()
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        cv.notify_one();
+      }
+
+      /**
+       * @brief Destroy queued tries until closed, then drain the rest.
+       */
+      void run()
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        for (;;)
+        {
+          cv.wait(lock, [this]
+                  { return closed || !queue.empty(); });
+          if (queue.empty())
+          {
+            return;
+          }
+          std::vector<std::shared_ptr<const Trie>> batch = std::move(queue);
+          queue.clear();
+          lock.unlock();
+          batch.clear();
+          lock.lock();
+        }
+      }
+    };
+
+    std::atomic<std::shared_ptr<const Trie>> current_;
+    std::atomic<std::uint64_t> version_{0};
+    std::shared_ptr<Reaper> reaper_{std::make_shared<Reaper>()};
+    std::thread reaper_thread_{};
+    std::thread worker_{};
+    std::exception_ptr error_{};
+  };
+
+} // namespace trie
+
+#endif // TRIE_TRIE_LOADER_HPP
@@ -0,0 +1,406 @@
+/**
+ * @file trie_map.hpp
+ * @brief Trie from byte-string keys to values of any type.
+ *
+ * Notes:
+ * - The key is the path: it is stored once, in the nodes, and a lookup is one
+ *   walk. No hash and no second copy of the key, as a side
+ *   std::unordered_map<std::string, T> would need.
+ * - Nodes live in the arena and stay trivially destructible. Values live in a
+ *   std::deque of slots owned by the map, so they may be any movable or
+ *   emplace-constructible type and are destroyed with the map. A reference to
+ *   a value stays valid until its key is erased.
+ * - for_each_prefix() visits (key, value) pairs in byte order, like
+ *   Trie::suggest().
+ */
+
+#ifndef TRIE_TRIE_MAP_HPP
+#define TRIE_TRIE_MAP_HPP
+
+#include <trie/detail/arena.hpp>
+#include <trie/detail/child_map.hpp>
+#include <trie/detail/scoring.hpp>
+#include <trie/query_context.hpp>
+#include <trie/stats.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace trie
+{
+  /**
+   * @brief TrieMap node. A terminal node's value is slot @p slot of its map.
+   */
+  struct TrieMapNode final
+  {
+    detail::ChildMap<TrieMapNode> children{};
+    std::uint32_t slot{0};
+    bool is_terminal{false};
+  };
+
+  static_assert(std::is_trivially_destructible_v<TrieMapNode>,
+                "trie map nodes are released with their arena and never destructed");
+
+  /**
+   * @brief Map from std::string_view keys to @p Value with prefix iteration.
+   *
+   * Features:
+   * - find(key), contains(key)
+   * - try_emplace(key, args...), insert_or_assign(key, value), operator[](key)
+   * - erase(key)
+   * - for_each_prefix(prefix, visit): `visit(std::string_view key, Value &value)`
+   * - size(), empty(), stats()
+   *
+   * Thread safety:
+   * - NOT thread-safe. Values are handed out by reference, so callers that
+   *   share a map must guard it, and the values, themselves.
+   */
+  template <typename Value>
+  class TrieMap final
+  {
+  public:
+    using mapped_type = Value;
+
+    /**
+     * @brief Construct an empty map.
+     * @param resource Upstream memory resource for node chunks.
+     */
+    explicit TrieMap(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : arena_(resource),
+          root_(arena_.create<TrieMapNode>())
+    {
+    }
+
+    TrieMap(const TrieMap &) = delete;
+    TrieMap &operator=(const TrieMap &) = delete;
+
+    /**
+     * @brief Value of @p key, or nullptr. One walk answers both "exists" and "what".
+     */
+    Value *find(std::string_view key) noexcept
+    {
+      const TrieMapNode *node = locate(key);
+      return (node && node->is_terminal) ? &*values_[node->slot] : nullptr;
+    }
+
+    const Value *find(std::string_view key) const noexcept
+    {
+      const TrieMapNode *node = locate(key);
+      return (node && node->is_terminal) ? &*values_[node->slot] : nullptr;
+    }
+
+    bool contains(std::string_view key) const noexcept { return find(key) != nullptr; }
+
+    /**
+     * @brief Construct the value of @p key from @p args unless the key is present.
+     *
+     * If constructing the value throws, the nodes created for @p key are
+     * pruned again and the map is unchanged.
+     * @return The key's value, and true if it was inserted.
+     */
+    template <typename... Args>
+    std::pair<Value &, bool> try_emplace(std::string_view key, Args &&...args)
+    {
+      TrieMapNode *node = root_;
+      std::size_t depth = 0;
+      for (; depth < key.size(); ++depth)
+      {
+        TrieMapNode *next = node->children.find(key[depth]);
+        if (!next)
+        {
+          break;
+        }
+        node = next;
+      }
+
+      if (depth == key.size() && node->is_terminal)
+      {
+        return {*values_[node->slot], false};
+      }
+
+      // Nodes below branch are created here.
+      TrieMapNode *const branch = node;
+      const std::size_t branch_depth = depth;
+      try
+      {
+        for (; depth < key.size(); ++depth)
+        {
+          TrieMapNode *next = arena_.create<TrieMapNode>();
+          try
+          {
+            node->children.emplace(key[depth], next, arena_);
+          }
+          catch (...)
+          {
+            arena_.destroy(next);
+            throw;
+          }
+          node = next;
+        }
+        node->slot = emplace_value(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+        prune_chain(branch, key.substr(branch_depth));
+        throw;
+      }
+
+      node->is_terminal = true;
+      ++size_;
+      return {*values_[node->slot], true};
+    }
+
+    /**
+     * @brief Set the value of @p key, inserting the key if needed.
+     * @return The key's value, and true if it was inserted.
+     */
+    template <typename V>
+    std::pair<Value &, bool> insert_or_assign(std::string_view key, V &&value)
+    {
+      auto [slot, inserted] = try_emplace(key, std::forward<V>(value));
+      if (!inserted)
+      {
+        slot = std::forward<V>(value);
+      }
+      return {slot, inserted};
+    }
+
+    /**
+     * @brief Value of @p key, value-initialized first if the key is missing.
+     */
+    Value &operator[](std::string_view key)
+      requires std::is_default_constructible_v<Value>
+    {
+      return try_emplace(key).first;
+    }
+
+    /**
+     * @brief Remove @p key and destroy its value. Emptied branches are pruned.
+     * @return true if the key was present.
+     */
+    bool erase(std::string_view key)
+    {
+      path_.clear();
+      TrieMapNode *node = root_;
+      path_.push_back(node);
+      for (char c : key)
+      {
+        node = node->children.find(c);
+        if (!node)
+        {
+          return false;
+        }
+        path_.push_back(node);
+      }
+      if (!node->is_terminal)
+      {
+        return false;
+      }
+
+      values_[node->slot].reset();
+      free_slots_.push_back(node->slot);
+      node->is_terminal = false;
+      --size_;
+
+      for (std::size_t i = path_.size(); i-- > 1;)
+      {
+        TrieMapNode *n = path_[i];
+        if (n->is_terminal || !n->children.empty())
+        {
+          break;
+        }
+        path_[i - 1]->children.erase(key[i - 1], arena_);
+        arena_.destroy(n);
+      }
+      return true;
+    }
+
+    /**
+     * @brief Visit every (key, value) whose key starts with @p prefix, in byte order.
+     *
+     * The key view is valid during the call only. A visitor may return false
+     * to stop. It must not insert or erase.
+     * @return Number of entries visited.
+     */
+    template <typename Visitor>
+    std::size_t for_each_prefix(std::string_view prefix, Visitor &&visit)
+    {
+      QueryContext ctx;
+      return walk(*this, prefix, ctx, visit);
+    }
+
+    template <typename Visitor>
+    std::size_t for_each_prefix(std::string_view prefix, Visitor &&visit) const
+    {
+      QueryContext ctx;
+      return walk(*this, prefix, ctx, visit);
+    }
+
+    /**
+     * @brief for_each_prefix() using the buffers of @p ctx. Does not allocate once they are warm.
+     */
+    template <typename Visitor>
+    std::size_t for_each_prefix(std::string_view prefix, QueryContext &ctx, Visitor &&visit)
+    {
+      return walk(*this, prefix, ctx, visit);
+    }
+
+    template <typename Visitor>
+    std::size_t for_each_prefix(std::string_view prefix, QueryContext &ctx, Visitor &&visit) const
+    {
+      return walk(*this, prefix, ctx, visit);
+    }
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    /**
+     * @brief Node counts, bytes by category, fan-out and depth histograms (see Trie::stats()).
+     *
+     * payload_bytes counts the value slots, free ones included.
+     */
+    TrieStats stats() const
+    {
+      TrieStats s;
+      std::vector<std::pair<const TrieMapNode *, std::size_t>> stack{{root_, 0}};
+      while (!stack.empty())
+      {
+        const auto [node, depth] = stack.back();
+        stack.pop_back();
+        detail::record_node(s, *node, depth);
+        for (const auto &kv : node->children)
+        {
+          stack.emplace_back(kv.second, depth + 1);
+        }
+      }
+      s.payload_bytes = values_.size() * sizeof(std::optional<Value>);
+      s.reserved_bytes = arena_.reserved_bytes();
+      return s;
+    }
+
+  private:
+    const TrieMapNode *locate(std::string_view key) const noexcept
+    {
+      const TrieMapNode *node = root_;
+      for (char c : key)
+      {
+        node = node->children.find(c);
+        if (!node)
+        {
+          return nullptr;
+        }
+      }
+      return node;
+    }
+
+    /**
+     * @brief Remove the single-child chain spelling @p suffix below @p parent.
+     */
+    void prune_chain(TrieMapNode *parent, std::string_view suffix) noexcept
+    {
+      TrieMapNode *node = suffix.empty() ? nullptr : parent->children.find(suffix[0]);
+      if (!node)
+      {
+        return;
+      }
+      parent->children.erase(suffix[0], arena_);
+      for (std::size_t i = 1; node; ++i)
+      {
+        TrieMapNode *next = i < suffix.size() ? node->children.find(suffix[i]) : nullptr;
+        arena_.destroy(node);
+        node = next;
+      }
+    }
+
+    template <typename... Args>
+    std::uint32_t emplace_value(Args &&...args)
+    {
+      if (!free_slots_.empty())
+      {
+        const std::uint32_t slot = free_slots_.back();
+        values_[slot].emplace(std::forward<Args>(args)...);
+        free_slots_.pop_back();
+        return slot;
+      }
+      if (values_.size() >= std::numeric_limits<std::uint32_t>::max())
+      {
+        throw std::length_error("trie: too many values in a TrieMap");
+      }
+      values_.emplace_back(std::in_place, std::forward<Args>(args)...);
+      return static_cast<std::uint32_t>(values_.size() - 1);
+    }
+
+    /**
+     * @brief Preorder walk below @p prefix on the scratch stack of @p ctx.
+     *
+     * @p Self is TrieMap or const TrieMap, so visitors get Value & or const Value &.
+     */
+    template <typename Self, typename Visitor>
+    static std::size_t walk(Self &self, std::string_view prefix, QueryContext &ctx, Visitor &visit)
+    {
+      const TrieMapNode *node = self.locate(prefix);
+      if (!node)
+      {
+        return 0;
+      }
+
+      detail::QueryScratch &sc = detail::QueryAccess::scratch(ctx);
+      sc.key.assign(prefix);
+      sc.stack.clear();
+
+      std::size_t count = 0;
+      for (;;)
+      {
+        if (node->is_terminal)
+        {
+          ++count;
+          if (!detail::emit_entry(visit, std::string_view(sc.key), *self.values_[node->slot]))
+          {
+            return count;
+          }
+        }
+
+        const std::size_t mark = sc.stack.size();
+        const auto key_size = static_cast<std::uint32_t>(sc.key.size());
+        for (const auto &kv : node->children)
+        {
+          sc.stack.push_back(detail::Frame{reinterpret_cast<std::uintptr_t>(kv.second),
+                                           key_size,
+                                           static_cast<unsigned char>(kv.first)});
+        }
+        std::reverse(sc.stack.begin() + static_cast<std::ptrdiff_t>(mark), sc.stack.end());
+
+        if (sc.stack.empty())
+        {
+          return count;
+        }
+        const detail::Frame f = sc.stack.back();
+        sc.stack.pop_back();
+        node = reinterpret_cast<const TrieMapNode *>(f.node);
+        sc.key.resize(f.key_size);
+        sc.key.push_back(static_cast<char>(f.aux));
+      }
+    }
+
+    detail::Arena arena_;
+    TrieMapNode *root_;
+    std::deque<std::optional<Value>> values_{};
+    std::vector<std::uint32_t> free_slots_{};
+    /// Scratch path of erase().
+    std::vector<TrieMapNode *> path_{};
+    std::size_t size_{0};
+  };
+
+} // namespace trie
+
+#endif // TRIE_TRIE_MAP_HPP
@@ -1,7 +1,18 @@
 #include <trie/trie.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <random>
+#include <ranges>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 static void test_insert_and_contains()
@@ -33,9 +44,9 @@ static void test_suggest_basic()
   const auto s1 = t.suggest("ali");
   assert(!s1.empty());
 
-  bool has_ali = false;
-  bool has_alice = false;
-  bool has_alicia = false;
+  [[maybe_unused]] bool has_ali = false;
+  [[maybe_unused]] bool has_alice = false;
+  [[maybe_unused]] bool has_alicia = false;
 
   for (const auto &w : s1)
   {
@@ -68,6 +79,551 @@ static void test_suggest_limit()
   assert(s.size() == 2);
 }
 
+static void test_suggest_after()
+{
+  trie::Trie t;
+  std::mt19937 rng(5);
+  for (int i = 0; i < 400; ++i)
+  {
+    std::string w = "p";
+    const std::size_t n = rng() % 5;
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      w.push_back("ab\xff"[rng() % 3]);
+    }
+    t.insert(w);
+  }
+  t.insert("q");
+
+  for (std::string_view prefix : {"", "p", "pa", "pb\xff"})
+  {
+    const std::vector<std::string> all = t.suggest(prefix);
+
+    // Paging through with the last word of each page yields suggest() in order.
+    std::vector<std::string> paged;
+    std::string last;
+    for (;;)
+    {
+      const std::vector<std::string> page = t.suggest_after(prefix, last, 7);
+      paged.insert(paged.end(), page.begin(), page.end());
+      if (page.size() < 7)
+      {
+        break;
+      }
+      last = page.back();
+    }
+    assert(paged == all);
+
+    // Arbitrary cursors, present or not, inside or outside the prefix range.
+    for (std::string_view after : {"", "a", "p", "pa", "pab", "pb", "pba\xff\xff\xff", "pz", "q", "\xff"})
+    {
+      std::vector<std::string> expected;
+      for (const std::string &w : all)
+      {
+        if (std::string_view(w) > after)
+        {
+          expected.push_back(w);
+        }
+      }
+      assert(t.suggest_after(prefix, after, 0) == expected);
+      expected.resize(std::min<std::size_t>(expected.size(), 3));
+      assert(t.suggest_after(prefix, after, 3) == expected);
+    }
+  }
+  assert(t.suggest_after("x", "", 0).empty());
+}
+
+static void test_suggest_top()
+{
+  trie::Trie t;
+
+  const auto add = [&](const std::string &w, int n)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      t.insert(w);
+    }
+  };
+
+  add("app", 2);
+  add("apple", 5);
+  add("application", 3);
+  add("apply", 5);
+  add("apt", 1);
+  add("banana", 9);
+
+  assert((t.suggest_top("ap", 3) == std::vector<std::string>{"apple", "apply", "application"}));
+  assert((t.suggest_top("app", 0) == std::vector<std::string>{"apple", "apply", "application", "app"}));
+  assert((t.suggest_top("", 1) == std::vector<std::string>{"banana"}));
+  assert(t.suggest_top("x", 3).empty());
+}
+
+static void test_high_fanout()
+{
+  trie::Trie t;
+
+  // Reverse order exercises sorted insertion in both child layouts.
+  for (int b = 255; b >= 0; --b)
+  {
+    t.insert(std::string(1, static_cast<char>(b)) + "x");
+  }
+
+  for (int b = 0; b < 256; ++b)
+  {
+    assert(t.contains(std::string(1, static_cast<char>(b)) + "x"));
+    assert(!t.contains(std::string(1, static_cast<char>(b))));
+  }
+
+  const auto all = t.suggest("");
+  assert(all.size() == 256);
+  assert(std::is_sorted(all.begin(), all.end()));
+}
+
+namespace
+{
+  class CountingResource final : public std::pmr::memory_resource
+  {
+  public:
+    std::size_t live{0};
+    std::size_t allocations{0};
+
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+      live += bytes;
+      ++allocations;
+      return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+      live -= bytes;
+      std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+      return this == &other;
+    }
+  };
+} // namespace
+
+static void test_memory_resource()
+{
+  CountingResource resource;
+
+  {
+    trie::Trie t(&resource);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+      t.insert("word" + std::to_string(i));
+    }
+
+    // Deep keys must not recurse on teardown.
+    t.insert(std::string(100000, 'z'));
+
+    assert(t.contains("word999"));
+    assert(t.contains(std::string(100000, 'z')));
+    assert(resource.live > 0);
+
+    // Nodes are carved from chunks, not allocated one by one.
+    assert(resource.allocations < 100);
+  }
+
+  assert(resource.live == 0);
+}
+
+static void test_build_from_sorted()
+{
+  std::vector<std::string> words;
+  for (int i = 0; i < 300; ++i)
+  {
+    words.push_back("w" + std::to_string(i * 7919 % 1000));
+    words.push_back(std::string(1, static_cast<char>(i)) + "x");
+  }
+  words.push_back("");
+  words.push_back("w1");
+  std::sort(words.begin(), words.end());
+
+  for (trie::Concurrency mode : {trie::Concurrency::none, trie::Concurrency::snapshot})
+  {
+    trie::Trie ref;
+    for (const auto &w : words)
+    {
+      ref.insert(w);
+    }
+
+    trie::Trie t(mode);
+    t.build_from_sorted(words);
+    assert(t.to_flat() == ref.to_flat());
+    assert(t.suggest_top("w", 3) == ref.suggest_top("w", 3));
+
+    t.insert("w1");
+    assert(t.contains("w1"));
+  }
+
+  trie::Trie weighted;
+  const std::vector<std::pair<std::string, int>> counts = {{"apple", 3}, {"apply", 7}, {"banana", 1}};
+  weighted.build_from_sorted(counts);
+  assert((weighted.suggest_top("app", 2) == std::vector<std::string>{"apply", "apple"}));
+
+  // Repeated words sum, saturating like insert(word, weight).
+  trie::Trie saturated;
+  const trie::Frequency top = std::numeric_limits<trie::Frequency>::max();
+  saturated.build_from_sorted(std::vector<std::pair<std::string, trie::Frequency>>{{"hot", top}, {"hot", 5}});
+  assert(saturated.frequency("hot") == top);
+
+  [[maybe_unused]] bool threw = false;
+  try
+  {
+    weighted.build_from_sorted(words);
+  }
+  catch (const std::logic_error &)
+  {
+    threw = true;
+  }
+  assert(threw);
+
+  trie::Trie unsorted;
+  threw = false;
+  try
+  {
+    unsorted.build_from_sorted(std::vector<std::string>{"b", "a"});
+  }
+  catch (const std::invalid_argument &)
+  {
+    threw = true;
+  }
+  assert(threw);
+  assert(!unsorted.contains("b"));
+  assert(unsorted.suggest("").empty());
+}
+
+static void test_erase_and_add_frequency()
+{
+  for (trie::Concurrency mode : {trie::Concurrency::none, trie::Concurrency::snapshot})
+  {
+    trie::Trie t(mode);
+    t.insert("app");
+    t.insert("apple");
+    t.insert("apple");
+    t.insert("apply");
+    for (int b = 0; b < 256; ++b)
+    {
+      t.insert(std::string("z") + static_cast<char>(b));
+    }
+
+    assert(!t.erase("ap"));
+    assert(!t.erase("missing"));
+    assert(t.erase("apple"));
+    assert(!t.contains("apple"));
+    assert(t.contains("app") && t.contains("apply"));
+    assert(!t.erase("apple"));
+
+    assert(t.add_frequency("apply", 4) == 5);
+    assert(t.add_frequency("apply", -2) == 3);
+    assert(t.frequency("apply") == 3);
+    assert(t.add_frequency("app", -1) == 0);
+    assert(!t.contains("app"));
+    assert(t.add_frequency("nothing", -3) == 0);
+    assert(!t.contains("nothing"));
+    assert(t.add_frequency("new", 2) == 2);
+
+    for (int b = 0; b < 256; ++b)
+    {
+      if (b != 'q')
+      {
+        assert(t.erase(std::string("z") + static_cast<char>(b)));
+      }
+    }
+
+    // Pruned nodes and refreshed max_frequency leave the same trie as a fresh build.
+    trie::Trie ref;
+    ref.add_frequency("apply", 3);
+    ref.add_frequency("new", 2);
+    ref.insert("zq");
+    assert(t.to_flat() == ref.to_flat());
+    assert((t.suggest_top("", 0) == std::vector<std::string>{"apply", "new", "zq"}));
+
+    assert(t.erase("apply") && t.erase("new") && t.erase("zq"));
+    assert(t.to_flat() == trie::Trie().to_flat());
+  }
+}
+
+static void test_weighted_insert_and_merge()
+{
+  trie::Trie t;
+  t.insert("hot", 3'000'000'000u);
+  t.insert("hot", 3'000'000'000u);
+  assert(t.frequency("hot") == 6'000'000'000u);
+  t.insert("hot", std::numeric_limits<trie::Frequency>::max());
+  assert(t.frequency("hot") == std::numeric_limits<trie::Frequency>::max());
+  t.insert("cold", 0);
+  assert(t.contains("cold") && t.frequency("cold") == 0);
+
+  // A zero-frequency word ranks last but is still a completion, from any prefix.
+  assert((t.suggest_top("co", 0) == std::vector<std::string>{"cold"}));
+  assert((t.suggest_top("cold", 1) == std::vector<std::string>{"cold"}));
+  assert((t.suggest_top("", 0) == std::vector<std::string>{"hot", "cold"}));
+  const std::vector<std::byte> image = t.to_flat();
+  assert((trie::FlatTrieView(image).suggest_top("co", 0) == std::vector<std::string>{"cold"}));
+
+  std::mt19937 rng(7);
+  std::vector<std::pair<std::string, std::uint32_t>> owned;
+  for (int i = 0; i < 2000; ++i)
+  {
+    owned.emplace_back("q" + std::to_string(rng() % 700), static_cast<std::uint32_t>(rng() % 50 + 1));
+  }
+  std::vector<std::pair<std::string_view, std::uint32_t>> counts(owned.begin(), owned.end());
+
+  for (trie::Concurrency mode : {trie::Concurrency::none, trie::Concurrency::snapshot})
+  {
+    trie::Trie merged(mode);
+    trie::Trie ref;
+    merged.insert("q1", 9);
+    ref.insert("q1", 9);
+    merged.insert("r");
+    ref.insert("r");
+
+    merged.merge_counts(counts);
+    for (const auto &kv : counts)
+    {
+      ref.insert(kv.first, kv.second);
+    }
+    assert(merged.to_flat() == ref.to_flat());
+    assert(merged.suggest_top("q", 5) == ref.suggest_top("q", 5));
+
+    merged.merge_counts(std::vector<std::string>{"r", "s", "r"});
+    assert(merged.frequency("r") == 3 && merged.frequency("s") == 1);
+
+    // A range yielding pairs by value: words longer than SSO outlive each element.
+    const std::vector<int> ids{3, 1, 2, 1};
+    merged.merge_counts(ids | std::views::transform([](int id)
+                                                    { return std::pair<std::string, int>("long-generated-word-" + std::to_string(id), id); }));
+    assert(merged.frequency("long-generated-word-1") == 2 && merged.frequency("long-generated-word-3") == 3);
+
+    // Negative counts are rejected and leave the trie unchanged.
+    [[maybe_unused]] const std::uint64_t generation = merged.generation();
+    [[maybe_unused]] bool threw = false;
+    try
+    {
+      merged.merge_counts(std::vector<std::pair<std::string, int>>{{"neg", 2}, {"neg", -1}});
+    }
+    catch (const std::invalid_argument &)
+    {
+      threw = true;
+    }
+    assert(threw && !merged.contains("neg") && merged.generation() == generation);
+  }
+}
+
+static void test_child_map_hysteresis()
+{
+  trie::Trie t;
+  for (const char *w : {"a", "b", "c", "d", "e"})
+  {
+    t.insert(w);
+  }
+  [[maybe_unused]] const std::size_t wide = t.stats().child_map_bytes;
+  assert(wide > 0);
+
+  // Toggling the fifth child keeps the wide block instead of reallocating it.
+  for (int i = 0; i < 4; ++i)
+  {
+    [[maybe_unused]] const bool erased = t.erase("e");
+    assert(erased);
+    assert(t.stats().child_map_bytes == wide && !t.contains("e") && t.contains("d"));
+    t.insert("e");
+    assert(t.stats().child_map_bytes == wide && t.contains("e"));
+  }
+
+  // Half the inline capacity moves the children back inline.
+  for (const char *w : {"e", "d", "c"})
+  {
+    t.erase(w);
+  }
+  assert(t.stats().child_map_bytes == 0);
+  assert((t.suggest("") == std::vector<std::string>{"a", "b"}));
+
+  t.shrink_to_fit();
+  assert((t.suggest("") == std::vector<std::string>{"a", "b"}));
+}
+
+static void test_stats_and_shrink_to_fit()
+{
+  for (trie::Concurrency mode : {trie::Concurrency::none, trie::Concurrency::shared, trie::Concurrency::snapshot})
+  {
+    trie::Trie t(mode);
+    std::mt19937 rng(11);
+    std::vector<std::string> words;
+    for (int i = 0; i < 3000; ++i)
+    {
+      std::string w;
+      const std::size_t n = 1 + rng() % 6;
+      for (std::size_t j = 0; j < n; ++j)
+      {
+        w.push_back(static_cast<char>('a' + rng() % 26));
+      }
+      t.insert(w);
+      words.push_back(w);
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    // Erase most words, so that freed nodes sit on the arena's free lists.
+    std::vector<std::string> kept;
+    for (std::size_t i = 0; i < words.size(); ++i)
+    {
+      if (i % 4 == 0)
+      {
+        kept.push_back(words[i]);
+      }
+      else
+      {
+        assert(t.erase(words[i]));
+      }
+    }
+    words = kept;
+
+    std::vector<std::string> prefixes{""};
+    for (const std::string &w : words)
+    {
+      for (std::size_t i = 1; i <= w.size(); ++i)
+      {
+        prefixes.push_back(w.substr(0, i));
+      }
+    }
+    std::sort(prefixes.begin(), prefixes.end());
+    prefixes.erase(std::unique(prefixes.begin(), prefixes.end()), prefixes.end());
+
+    const auto check_shape = [&](const trie::TrieStats &s)
+    {
+      assert(s.nodes == prefixes.size());
+      assert(s.terminals == words.size());
+      assert(s.node_bytes == s.nodes * sizeof(trie::TrieNode));
+      assert(s.payload_bytes == 0);
+      assert(s.used_bytes() <= s.reserved_bytes);
+
+      std::size_t nodes = 0, edges = 0, depth_nodes = 0;
+      for (std::size_t c = 0; c < s.fanout.size(); ++c)
+      {
+        nodes += s.fanout[c];
+        edges += c * s.fanout[c];
+      }
+      for (std::size_t n : s.depth)
+      {
+        depth_nodes += n;
+      }
+      assert(nodes == s.nodes && edges == s.nodes - 1 && depth_nodes == s.nodes);
+      assert(s.depth.size() == 7 && s.depth[0] == 1 && s.depth[1] == 26);
+      assert(s.fanout.size() == 27);
+    };
+
+    const trie::TrieStats before = t.stats();
+    check_shape(before);
+    assert(before.child_map_slack_bytes > 0);
+
+    const std::vector<std::string> all = t.suggest("");
+    const std::vector<std::string> ranked = t.search_ranked("abc", 20);
+    [[maybe_unused]] const std::uint64_t generation = t.generation();
+
+    t.shrink_to_fit();
+    const trie::TrieStats after = t.stats();
+    check_shape(after);
+    assert(after.child_map_slack_bytes == 0);
+    assert(after.child_map_bytes == before.child_map_bytes - before.child_map_slack_bytes);
+    assert(after.fanout == before.fanout && after.depth == before.depth);
+    if (mode != trie::Concurrency::snapshot)
+    {
+      assert(after.reserved_bytes < before.reserved_bytes);
+    }
+    assert(t.generation() > generation);
+
+    assert(t.suggest("") == all);
+    assert(t.search_ranked("abc", 20) == ranked);
+    assert(t.suggest_top("a", 5) == t.suggest_top("a", 5));
+    for ([[maybe_unused]] const std::string &w : words)
+    {
+      assert(t.contains(w));
+    }
+
+    // The compacted trie keeps accepting writes.
+    t.insert("zzzzzzz");
+    assert(t.erase(words.front()));
+    assert(t.contains("zzzzzzz") && !t.contains(words.front()));
+  }
+
+  trie::Trie empty;
+  empty.shrink_to_fit();
+  const trie::TrieStats s = empty.stats();
+  assert(s.nodes == 1 && s.terminals == 0 && s.fanout == std::vector<std::size_t>{1});
+}
+
+static void test_deep_keys()
+{
+  // Walks use an explicit stack: a key this long would overflow the call
+  // stack if traversal recursed once per byte.
+  const std::string deep(300000, 'd');
+  trie::Trie t;
+  t.insert(deep);
+  t.insert(deep + "x");
+  t.insert("dd");
+
+  assert((t.suggest("ddd", 0).size() == 2));
+  assert(t.suggest("", 1) == std::vector<std::string>{"dd"});
+  assert(t.search_ranked("dd", 0).size() == 3);
+  assert(t.search_fuzzy("ddd", 1).size() == 1);
+
+  const std::vector<std::byte> image = t.to_flat();
+  const trie::FlatTrieView view(image);
+  assert(view.suggest("dd", 0) == t.suggest("dd", 0));
+  assert(view.search_ranked("dd", 3) == t.search_ranked("dd", 3));
+}
+
+static void test_batch_queries()
+{
+  trie::Trie t;
+  std::vector<std::string> words;
+  for (int i = 0; i < 500; ++i)
+  {
+    words.push_back("k" + std::to_string(i * 37 % 1000));
+    t.insert(words.back());
+  }
+
+  std::vector<std::string> probes = {"", "k", "k1", "k999", "zzz"};
+  for (int i = 0; i < 100; ++i)
+  {
+    probes.push_back("k" + std::to_string(i));
+  }
+  const std::vector<std::string_view> views(probes.begin(), probes.end());
+
+  bool found[128];
+  t.contains_many(views, std::span<bool>(found, views.size()));
+  for (std::size_t i = 0; i < views.size(); ++i)
+  {
+    assert(found[i] == t.contains(views[i]));
+  }
+
+  const auto batch = t.suggest_many(views, 3);
+  assert(batch.size() == views.size());
+  for (std::size_t i = 0; i < views.size(); ++i)
+  {
+    assert(batch[i] == t.suggest(views[i], 3));
+  }
+
+  [[maybe_unused]] bool threw = false;
+  try
+  {
+    t.contains_many(views, std::span<bool>(found, 2));
+  }
+  catch (const std::invalid_argument &)
+  {
+    threw = true;
+  }
+  assert(threw);
+}
+
 static void test_search_ranked()
 {
   trie::Trie t;
@@ -85,6 +641,98 @@ static void test_search_ranked()
   assert(r[0] != "world");
 }
 
+static void test_bit_parallel_distance()
+{
+  std::mt19937 rng(3);
+  std::uniform_int_distribution<int> len(0, 70);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  trie::detail::QueryScratch sc;
+  std::vector<int> rows;
+  for (int iter = 0; iter < 2000; ++iter)
+  {
+    std::string query;
+    std::string word;
+    const int alphabet = iter % 2 == 0 ? 3 : 256;
+    for (int i = len(rng); i > 0; --i)
+      query.push_back(static_cast<char>(byte(rng) % alphabet));
+    for (int i = len(rng); i > 0; --i)
+      word.push_back(static_cast<char>(byte(rng) % alphabet));
+
+    sc.reset();
+    trie::detail::prepare_distance(sc, query);
+    assert(sc.peq.empty() == (query.size() > trie::detail::bit_parallel_max));
+    assert(trie::detail::levenshtein_distance(query, word, sc) ==
+           trie::detail::levenshtein_distance(query, word, rows));
+  }
+}
+
+static void test_search_ranked_limit()
+{
+  trie::Trie t;
+  for (int i = 0; i < 200; ++i)
+  {
+    // Many equal scores, so the lexicographic tie-break decides admission.
+    t.insert("k" + std::to_string(i % 50) + (i % 3 == 0 ? "x" : ""));
+  }
+
+  const auto all = t.search_ranked("k1", 0);
+  for (std::size_t limit : {1, 2, 5, 17, 80, 500})
+  {
+    const auto top = t.search_ranked("k1", limit);
+    [[maybe_unused]] const std::size_t n = std::min(limit, all.size());
+    assert(top.size() == n);
+    assert(std::equal(top.begin(), top.end(), all.begin()));
+
+    auto fuzzy = t.search_fuzzy("k1", 2, 0);
+    fuzzy.resize(std::min(limit, fuzzy.size()));
+    assert(t.search_fuzzy("k1", 2, limit) == fuzzy);
+  }
+}
+
+static void test_search_fuzzy()
+{
+  trie::Trie t;
+
+  t.insert("hello");
+  t.insert("hallo");
+  t.insert("help");
+  t.insert("helicopter");
+  t.insert("world");
+
+  const auto r = t.search_fuzzy("helo", 1);
+  assert(r.size() == 2);
+
+  [[maybe_unused]] bool has_hello = false;
+  [[maybe_unused]] bool has_help = false;
+  [[maybe_unused]] bool has_hallo = false;
+
+  for (const auto &w : r)
+  {
+    if (w == "hello")
+      has_hello = true;
+    if (w == "help")
+      has_help = true;
+    if (w == "hallo")
+      has_hallo = true;
+  }
+
+  assert(!has_hallo);
+  assert(has_hello);
+  assert(has_help);
+
+  // Same ranking as search_ranked when every word is within the bound.
+  assert(t.search_fuzzy("helo", 100, 3) == t.search_ranked("helo", 3));
+
+  assert(t.search_fuzzy("zzzz", 1).empty());
+  assert(t.search_fuzzy("help", 0) == std::vector<std::string>{"help"});
+
+  // Bounds past INT_MAX clamp instead of wrapping: every word matches.
+  [[maybe_unused]] const std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+  assert(t.search_fuzzy("hello", unbounded, 0).size() == 5);
+  assert(t.search_fuzzy("helo", unbounded, 3) == t.search_ranked("helo", 3));
+}
+
 static void test_thread_safe_flag_smoke()
 {
   trie::Trie t(true);
@@ -97,7 +745,21 @@ int main()
   test_insert_and_contains();
   test_suggest_basic();
   test_suggest_limit();
+  test_suggest_after();
+  test_suggest_top();
+  test_high_fanout();
+  test_memory_resource();
+  test_build_from_sorted();
+  test_erase_and_add_frequency();
+  test_weighted_insert_and_merge();
+  test_child_map_hysteresis();
+  test_stats_and_shrink_to_fit();
+  test_deep_keys();
+  test_batch_queries();
   test_search_ranked();
+  test_search_ranked_limit();
+  test_bit_parallel_distance();
+  test_search_fuzzy();
   test_thread_safe_flag_smoke();
   return 0;
 }
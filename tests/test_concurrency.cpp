@@ -0,0 +1,163 @@
+#include <trie/trie.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void run_readers_and_writer(trie::Trie &t, bool freeze = false)
+{
+  for (int i = 0; i < 200; ++i)
+  {
+    t.insert("base" + std::to_string(i));
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> failures{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r)
+  {
+    readers.emplace_back([&]
+                         {
+      while (!done.load())
+      {
+        if (!t.contains("base42"))
+          failures.fetch_add(1);
+        if (t.suggest("base1", 5).size() != 5)
+          failures.fetch_add(1);
+        if (t.search_fuzzy("base7", 1).empty())
+          failures.fetch_add(1);
+      } });
+  }
+
+  std::thread writer([&]
+                     {
+    for (int i = 0; i < 2000; ++i)
+    {
+      if (freeze && i % 100 == 0)
+      {
+        t.freeze();
+      }
+      t.insert("new" + std::to_string(i));
+    }
+    done.store(true); });
+
+  writer.join();
+  for (auto &th : readers)
+  {
+    th.join();
+  }
+
+  assert(failures.load() == 0);
+  for (int i = 0; i < 2000; ++i)
+  {
+    assert(t.contains("new" + std::to_string(i)));
+  }
+}
+
+static void test_exclusive_mode()
+{
+  trie::Trie t(true);
+  run_readers_and_writer(t);
+}
+
+static void test_shared_mode()
+{
+  trie::Trie t(trie::Concurrency::shared);
+  run_readers_and_writer(t);
+}
+
+static void test_snapshot_mode()
+{
+  trie::Trie t(trie::Concurrency::snapshot);
+  run_readers_and_writer(t);
+}
+
+static void test_freeze_while_reading()
+{
+  // Readers race with freeze() and with the inserts that drop each image.
+  for (trie::Concurrency mode : {trie::Concurrency::exclusive, trie::Concurrency::shared, trie::Concurrency::snapshot})
+  {
+    trie::Trie t(mode);
+    run_readers_and_writer(t, true);
+  }
+}
+
+static void test_snapshot_mode_single_thread()
+{
+  trie::Trie t(trie::Concurrency::snapshot);
+
+  t.insert("alice");
+  t.insert("alicia");
+  t.insert("ali");
+  t.insert("ali");
+
+  assert(t.contains("alice"));
+  assert(t.contains("alicia"));
+  assert(t.contains("ali"));
+  assert(!t.contains("al"));
+
+  const auto s = t.suggest("ali");
+  assert((s == std::vector<std::string>{"ali", "alice", "alicia"}));
+
+  // Repeated inserts ranked by frequency, as in the other modes.
+  assert(t.search_ranked("ali", 1) == std::vector<std::string>{"ali"});
+  assert((t.suggest_top("al", 2) == std::vector<std::string>{"ali", "alice"}));
+}
+
+static void test_parallel_search_ranked()
+{
+  trie::Trie t(trie::Concurrency::shared);
+  for (int i = 0; i < 3000; ++i)
+  {
+    std::string w = "w" + std::to_string(i * 7919 % 5000);
+    t.insert(w);
+    if (i % 3 == 0)
+    {
+      t.insert(w);
+    }
+  }
+  t.insert("");
+  t.insert("w");
+
+  for (const char *query : {"w123", "w9", ""})
+  {
+    for (std::size_t limit : {std::size_t{1}, std::size_t{10}, std::size_t{0}})
+    {
+      const auto expected = t.search_ranked(query, limit);
+      for ([[maybe_unused]] std::size_t workers : {1, 2, 7})
+      {
+        assert(t.search_ranked_parallel(query, limit, workers) == expected);
+      }
+
+      std::size_t tasks = 0;
+      [[maybe_unused]] const auto inline_executor = [&tasks](std::size_t n, auto &&task)
+      {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          ++tasks;
+          task(i);
+        }
+      };
+      assert(t.search_ranked_parallel(query, limit, 4, inline_executor) == expected);
+      assert(tasks == 4);
+    }
+  }
+
+  trie::Trie empty;
+  assert(empty.search_ranked_parallel("x", 10, 4).empty());
+}
+
+int main()
+{
+  test_parallel_search_ranked();
+  test_exclusive_mode();
+  test_shared_mode();
+  test_snapshot_mode();
+  test_freeze_while_reading();
+  test_snapshot_mode_single_thread();
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include <trie/trie.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+static std::size_t edit_distance(const std::string &a, const std::string &b)
+{
+  std::vector<std::size_t> prev(b.size() + 1), cur(b.size() + 1);
+  for (std::size_t j = 0; j <= b.size(); ++j)
+    prev[j] = j;
+  for (std::size_t i = 1; i <= a.size(); ++i)
+  {
+    cur[0] = i;
+    for (std::size_t j = 1; j <= b.size(); ++j)
+      cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+    std::swap(prev, cur);
+  }
+  return prev[b.size()];
+}
+
+/// Reference for suggest_fuzzy(): words with a prefix within max_distance, by (distance, frequency desc, word).
+static std::vector<std::string> fuzzy_reference(
+    const std::map<std::string, unsigned> &counts,
+    const std::string &query,
+    std::size_t max_distance)
+{
+  std::vector<std::tuple<std::size_t, long, std::string>> hits;
+  for (const auto &[word, freq] : counts)
+  {
+    std::size_t best = max_distance + 1;
+    for (std::size_t n = 0; n <= word.size(); ++n)
+    {
+      best = std::min(best, edit_distance(query, word.substr(0, n)));
+    }
+    if (best <= max_distance)
+    {
+      hits.emplace_back(best, -static_cast<long>(freq), word);
+    }
+  }
+  std::sort(hits.begin(), hits.end());
+
+  std::vector<std::string> out;
+  for (const auto &h : hits)
+  {
+    out.push_back(std::get<2>(h));
+  }
+  return out;
+}
+
+static void test_exact_cursor(trie::Concurrency mode)
+{
+  trie::Trie t(mode);
+  for (const char *w : {"apple", "apply", "apt", "banana", "band", "bandana"})
+  {
+    t.insert(w);
+  }
+  t.insert("apply");
+
+  trie::Trie::Cursor c = t.cursor();
+  assert(c.suggest() == t.suggest(""));
+
+  for (char ch : std::string("apx"))
+  {
+    c.push(ch);
+    assert(c.suggest() == t.suggest(c.prefix()));
+    assert(c.suggest_top(2) == t.suggest_top(c.prefix(), 2));
+  }
+  assert(!c.matches());
+
+  c.pop();
+  assert(c.prefix() == "ap");
+  assert(c.matches());
+  assert((c.suggest_top(1) == std::vector<std::string>{"apply"}));
+
+  // The cursor notices the insert and rebuilds its path.
+  t.insert("apex");
+  assert((c.suggest(2) == std::vector<std::string>{"apex", "apple"}));
+
+  c.clear();
+  c.push('b');
+  assert(c.suggest() == t.suggest("b"));
+}
+
+static void test_fuzzy_cursor()
+{
+  std::mt19937 rng(5);
+  std::uniform_int_distribution<int> len(1, 7);
+  std::uniform_int_distribution<int> letter('a', 'd');
+
+  trie::Trie t;
+  std::map<std::string, unsigned> counts;
+  for (int i = 0; i < 400; ++i)
+  {
+    std::string w;
+    for (int n = len(rng); n > 0; --n)
+    {
+      w.push_back(static_cast<char>(letter(rng)));
+    }
+    t.insert(w);
+    ++counts[w];
+  }
+
+  for (std::size_t k : {1, 2})
+  {
+    trie::Trie::Cursor c = t.cursor(k);
+    const std::string typed = "dacbb";
+    for (char ch : typed)
+    {
+      c.push(ch);
+      const std::string q(c.prefix());
+      assert(c.suggest_fuzzy(0) == fuzzy_reference(counts, q, k));
+      const auto top = c.suggest_fuzzy(5);
+      const auto all = fuzzy_reference(counts, q, k);
+      assert(std::equal(top.begin(), top.end(), all.begin()));
+    }
+
+    while (!c.prefix().empty())
+    {
+      c.pop();
+      assert(c.suggest_fuzzy(0) == fuzzy_reference(counts, std::string(c.prefix()), k));
+    }
+  }
+
+  trie::Trie::Cursor exact = t.cursor();
+  exact.push('a');
+  assert(exact.suggest_fuzzy(3) == t.suggest_top("a", 3));
+}
+
+static void test_huge_distance_cursor()
+{
+  trie::Trie t;
+  for (const char *w : {"apple", "apply", "apt", "banana"})
+  {
+    t.insert(w);
+  }
+
+  // Bounds past the longest word match everything; they must neither wrap to
+  // an exact cursor nor spin once the frontier stops growing.
+  for (std::size_t k : {std::size_t{1} << 32, SIZE_MAX})
+  {
+    trie::Trie::Cursor c = t.cursor(k);
+    for (char ch : std::string("xyz"))
+    {
+      c.push(ch);
+    }
+    std::vector<std::string> all = c.suggest_fuzzy(0);
+    std::sort(all.begin(), all.end());
+    assert((all == std::vector<std::string>{"apple", "apply", "apt", "banana"}));
+  }
+}
+
+int main()
+{
+  test_exact_cursor(trie::Concurrency::none);
+  test_exact_cursor(trie::Concurrency::snapshot);
+  test_fuzzy_cursor();
+  test_huge_distance_cursor();
+  return 0;
+}
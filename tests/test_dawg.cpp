@@ -0,0 +1,133 @@
+#include <trie/dawg.hpp>
+#include <trie/trie.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+static std::vector<std::pair<std::string, std::uint32_t>> sample_counts()
+{
+  const char *stems[] = {"walk", "talk", "jump", "play", "read", "work", "call", "test"};
+  const char *suffixes[] = {"", "s", "ed", "er", "ers", "ing", "ings"};
+
+  std::vector<std::pair<std::string, std::uint32_t>> counts;
+  std::uint32_t f = 1;
+  for (const char *stem : stems)
+  {
+    for (const char *suffix : suffixes)
+    {
+      counts.emplace_back(std::string(stem) + suffix, f % 5 + 1);
+      ++f;
+    }
+  }
+  counts.emplace_back("", 2);
+  counts.emplace_back("x", 1);
+  std::sort(counts.begin(), counts.end());
+  return counts;
+}
+
+static void test_minimal_size()
+{
+  std::vector<std::string> words;
+  for (const auto &kv : sample_counts())
+  {
+    words.push_back(kv.first);
+  }
+
+  const trie::Dawg d = trie::Dawg::build_from_sorted(words);
+  assert(d.size() == words.size());
+
+  // The shared suffix set collapses to a handful of states; a trie needs one per byte.
+  assert(d.state_count() < 40);
+  for ([[maybe_unused]] const auto &w : words)
+  {
+    assert(d.contains(w));
+    assert(d.frequency(w) == 1);
+  }
+  assert(!d.contains("walkin"));
+  assert(!d.contains("walkeds"));
+  assert(d.frequency("walkeds") == 0);
+}
+
+static void test_matches_trie()
+{
+  const auto counts = sample_counts();
+
+  trie::Trie ref;
+  for (const auto &kv : counts)
+  {
+    for (std::uint32_t i = 0; i < kv.second; ++i)
+    {
+      ref.insert(kv.first);
+    }
+  }
+
+  const trie::Dawg d = trie::Dawg::build_from_sorted(counts);
+  for ([[maybe_unused]] const auto &kv : counts)
+  {
+    assert(d.frequency(kv.first) == kv.second);
+  }
+
+  for ([[maybe_unused]] const char *prefix : {"", "w", "walk", "talked", "q"})
+  {
+    assert(d.suggest(prefix) == ref.suggest(prefix));
+    assert(d.suggest(prefix, 3) == ref.suggest(prefix, 3));
+  }
+
+  for ([[maybe_unused]] const char *query : {"walkng", "plyer", "tests", ""})
+  {
+    assert(d.search_ranked(query, 10) == ref.search_ranked(query, 10));
+    assert(d.search_fuzzy(query, 2, 0) == ref.search_fuzzy(query, 2, 0));
+    assert(d.search_fuzzy(query, std::numeric_limits<std::size_t>::max(), 0) == ref.search_ranked(query, 0));
+  }
+}
+
+static void test_duplicates_and_order()
+{
+  const std::vector<std::pair<std::string, int>> counts = {{"a", 1}, {"a", 2}, {"ab", 1}};
+  const trie::Dawg d = trie::Dawg::build_from_sorted(counts);
+  assert(d.size() == 2);
+  assert(d.frequency("a") == 3);
+
+  [[maybe_unused]] bool threw = false;
+  try
+  {
+    trie::Dawg::build_from_sorted(std::vector<std::string>{"b", "a"});
+  }
+  catch (const std::invalid_argument &)
+  {
+    threw = true;
+  }
+  assert(threw);
+
+  const trie::Dawg empty;
+  assert(empty.size() == 0);
+  assert(!empty.contains(""));
+  assert(empty.suggest("").empty());
+  assert(empty.search_fuzzy("a", 1).empty());
+}
+
+static void test_deep_keys()
+{
+  const std::string deep(300000, 'd');
+  const std::vector<std::string> words = {"dd", deep, deep + "x"};
+  const trie::Dawg d = trie::Dawg::build_from_sorted(words);
+
+  assert(d.suggest("ddd").size() == 2);
+  assert(d.search_ranked("dd", 0).size() == 3);
+  assert(d.search_fuzzy("ddd", 1).size() == 1);
+}
+
+int main()
+{
+  test_minimal_size();
+  test_matches_trie();
+  test_duplicates_and_order();
+  test_deep_keys();
+  return 0;
+}
@@ -0,0 +1,285 @@
+#include <trie/flat_trie.hpp>
+#include <trie/mapped_trie.hpp>
+#include <trie/trie.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+static std::vector<std::string> sample_words()
+{
+  std::vector<std::string> words = {
+      "hello", "help", "helium", "hero", "her", "hallo", "world", "word", "",
+  };
+
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int> len(1, 10);
+  std::uniform_int_distribution<int> byte(0, 255);
+  for (int i = 0; i < 500; ++i)
+  {
+    std::string w;
+    const int n = len(rng);
+    for (int j = 0; j < n; ++j)
+    {
+      w.push_back(static_cast<char>(byte(rng) % 6 == 0 ? byte(rng) : 'a' + byte(rng) % 4));
+    }
+    words.push_back(w);
+  }
+  return words;
+}
+
+static void fill(trie::Trie &t)
+{
+  for (const auto &w : sample_words())
+  {
+    t.insert(w);
+  }
+  t.insert("hello");
+  t.insert("hello");
+  t.insert("help");
+}
+
+template <typename View>
+static void check_matches([[maybe_unused]] const trie::Trie &ref, [[maybe_unused]] const View &v)
+{
+  for ([[maybe_unused]] const auto &w : sample_words())
+  {
+    assert(v.contains(w));
+    assert(v.contains(w + "z") == ref.contains(w + "z"));
+  }
+  assert(!v.contains("helloo"));
+
+  for ([[maybe_unused]] const char *prefix : {"", "a", "he", "hel", "zz"})
+  {
+    assert(v.suggest(prefix) == ref.suggest(prefix));
+    assert(v.suggest(prefix, 3) == ref.suggest(prefix, 3));
+    assert(v.suggest_top(prefix, 5) == ref.suggest_top(prefix, 5));
+  }
+
+  for ([[maybe_unused]] const char *query : {"helo", "abcd", "word"})
+  {
+    assert(v.search_ranked(query, 10) == ref.search_ranked(query, 10));
+    assert(v.search_fuzzy(query, 2, 0) == ref.search_fuzzy(query, 2, 0));
+    assert(v.search_fuzzy(query, std::numeric_limits<std::size_t>::max(), 0) == ref.search_ranked(query, 0));
+  }
+}
+
+static void test_view_matches_trie()
+{
+  trie::Trie ref;
+  fill(ref);
+
+  const std::vector<std::byte> image = ref.to_flat();
+  const trie::FlatTrieView v(image);
+
+  assert(v.verify());
+  check_matches(ref, v);
+}
+
+static void test_mapped_round_trip()
+{
+  trie::Trie ref;
+  fill(ref);
+
+  const std::string path = "trie_flat_test.bin";
+  {
+    std::ofstream out(path, std::ios::binary);
+    ref.save(out);
+  }
+
+  {
+    trie::MappedTrie m(path);
+    assert(m.verify());
+    check_matches(ref, m);
+
+    trie::MappedTrie moved(std::move(m));
+    assert(moved.contains("hello"));
+  }
+
+  std::remove(path.c_str());
+
+  [[maybe_unused]] bool threw = false;
+  try
+  {
+    trie::MappedTrie missing("trie_flat_test_missing.bin");
+  }
+  catch (const std::system_error &)
+  {
+    threw = true;
+  }
+  assert(threw);
+}
+
+static void test_sorted_builder()
+{
+  trie::Trie ref;
+  fill(ref);
+
+  std::vector<std::string> words = sample_words();
+  words.push_back("hello");
+  words.push_back("hello");
+  words.push_back("help");
+  std::sort(words.begin(), words.end());
+
+  const std::vector<std::byte> image = trie::flat::build_from_sorted(words);
+  const trie::FlatTrieView v(image);
+  assert(v.verify());
+  assert(v.size() == ref.suggest("").size());
+  assert(v.node_count() == trie::FlatTrieView(ref.to_flat()).node_count());
+  check_matches(ref, v);
+
+  trie::flat::SortedBuilder b;
+  b.add("abc", 2);
+  b.add("abd");
+  [[maybe_unused]] bool threw = false;
+  try
+  {
+    b.add("abb");
+  }
+  catch (const std::invalid_argument &)
+  {
+    threw = true;
+  }
+  assert(threw);
+
+  const std::vector<std::byte> small = b.finish();
+  const trie::FlatTrieView sv(small);
+  assert(sv.size() == 2);
+  assert((sv.suggest_top("ab", 1) == std::vector<std::string>{"abc"}));
+
+  const std::vector<std::byte> none = b.finish();
+  const trie::FlatTrieView empty(none);
+  assert(empty.size() == 0 && empty.node_count() == 1);
+}
+
+static void test_rejects_bad_images()
+{
+  trie::Trie t;
+  t.insert("abc");
+  std::vector<std::byte> image = t.to_flat();
+
+  [[maybe_unused]] const auto rejects = [](std::span<const std::byte> bytes)
+  {
+    try
+    {
+      trie::FlatTrieView v(bytes);
+    }
+    catch (const std::invalid_argument &)
+    {
+      return true;
+    }
+    return false;
+  };
+
+  assert(!rejects(image));
+  assert(rejects(std::span<const std::byte>(image).first(16)));
+  assert(rejects(std::span<const std::byte>(image).first(image.size() - 1)));
+
+  std::vector<std::byte> bad_magic = image;
+  bad_magic[0] = std::byte{'X'};
+  assert(rejects(bad_magic));
+
+  // A child range pointing past the node array passes the O(1) header check
+  // but fails verify().
+  std::vector<std::byte> bad_child = image;
+  const std::uint32_t out_of_range = 1000;
+  std::memcpy(bad_child.data() + sizeof(trie::flat::Header), &out_of_range, sizeof(out_of_range));
+  const trie::FlatTrieView v(bad_child);
+  assert(!v.verify());
+
+  // In-range child ranges that loop back to the root, an ancestor or the node
+  // itself would make every walk endless. Node 2 is the "b" of "abc".
+  for (const std::uint32_t target : {0u, 1u, 2u})
+  {
+    std::vector<std::byte> cyclic = image;
+    std::memcpy(cyclic.data() + sizeof(trie::flat::Header) + 2 * sizeof(trie::flat::Node), &target, sizeof(target));
+    assert(!trie::FlatTrieView(cyclic).verify());
+  }
+}
+
+static void test_hot_path_layout()
+{
+  trie::Trie ref;
+  fill(ref);
+  for (int i = 0; i < 50; ++i)
+  {
+    ref.insert("word");
+  }
+
+  const std::vector<std::byte> image = ref.to_flat(trie::flat::Layout::hot_path);
+  assert(image.size() == ref.to_flat().size());
+  const trie::FlatTrieView v(image);
+  assert(v.verify());
+  check_matches(ref, v);
+
+  // Along the hottest word's path, each node's children block sits right
+  // after the block holding the node.
+  const auto *nodes = reinterpret_cast<const trie::flat::Node *>(image.data() + sizeof(trie::flat::Header));
+  const auto *labels = reinterpret_cast<const unsigned char *>(nodes + v.node_count());
+  std::uint32_t node = 0;
+  for (char c : std::string("wor"))
+  {
+    const trie::flat::Node &n = nodes[node];
+    const unsigned char *it = std::find(labels + n.first_child, labels + n.first_child + n.child_count,
+                                        static_cast<unsigned char>(c));
+    node = static_cast<std::uint32_t>(it - labels);
+    assert(nodes[node].first_child == n.first_child + n.child_count);
+  }
+  assert(v.frequency("word") == 51 && v.frequency("hello") == 3 && v.frequency("helloo") == 0);
+}
+
+static void test_freeze()
+{
+  for (trie::Concurrency mode : {trie::Concurrency::none, trie::Concurrency::shared, trie::Concurrency::snapshot})
+  {
+    trie::Trie ref;
+    fill(ref);
+    trie::Trie t(mode);
+    fill(t);
+
+    assert(!t.frozen());
+    t.freeze();
+    assert(t.frozen());
+    check_matches(ref, t);
+    assert(t.frequency("hello") == 3 && t.frequency("hel") == 0);
+
+    const std::vector<std::string_view> batch = {"hello", "hel", "word", "zzz"};
+    bool found[4] = {};
+    t.contains_many(batch, found);
+    assert(found[0] && !found[1] && found[2] && !found[3]);
+
+    // Node-backed queries see the same words.
+    assert(t.suggest_after("he", "hello", 0) == ref.suggest_after("he", "hello", 0));
+
+    // A write drops the image; the next freeze() picks the change up.
+    t.insert("helloo");
+    assert(!t.frozen() && t.contains("helloo"));
+    t.freeze();
+    assert(t.contains("helloo") && t.suggest("hello") == std::vector<std::string>({"hello", "helloo"}));
+    t.freeze();
+    assert(t.erase("helloo") && !t.frozen() && !t.contains("helloo"));
+    t.freeze();
+  }
+}
+
+int main()
+{
+  test_view_matches_trie();
+  test_mapped_round_trip();
+  test_sorted_builder();
+  test_rejects_bad_images();
+  test_hot_path_layout();
+  test_freeze();
+  return 0;
+}
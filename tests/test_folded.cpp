@@ -0,0 +1,132 @@
+#include <trie/folded_trie.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+static void test_fold()
+{
+  assert(trie::fold("Hello, World!") == "hello, world!");
+  assert(trie::fold("Ärger") == "arger");
+  assert(trie::fold("Straße") == "strasse" && trie::fold("STRASSE") == "strasse");
+  assert(trie::fold("Œuvre") == "oeuvre" && trie::fold("Łódź") == "lodz");
+  assert(trie::fold("Ÿ") == "y" && trie::fold("ſ") == "s");
+
+  // Outside the folded range, bytes are kept: other scripts, × and ÷,
+  // truncated sequences and stray continuation bytes.
+  assert(trie::fold("日本") == "日本");
+  assert(trie::fold("2×3÷4") == "2×3÷4");
+  assert(trie::fold("caf\xc3") == "caf\xc3");
+  assert(trie::fold("\x80\xa9") == "\x80\xa9");
+}
+
+static void test_spellings_share_a_key()
+{
+  trie::FoldedTrie t;
+  for (const char *w : {"Café", "cafe", "CAFÉ", "Cafeteria", "Zürich", "cafe"})
+  {
+    t.insert(w);
+  }
+
+  assert(t.size() == 5);
+  assert(t.contains("cafe") && t.contains("CAFE") && t.contains("café") && t.contains("CaFé"));
+  assert(!t.contains("caf") && !t.contains("cafes"));
+  assert((t.spellings("CAFE") == std::vector<std::string>{"CAFÉ", "Café", "cafe"}));
+  assert(t.spellings("zzz").empty());
+
+  assert((t.suggest("CAF") == std::vector<std::string>{"CAFÉ", "Café", "cafe", "Cafeteria"}));
+  assert((t.suggest("caf", 2) == std::vector<std::string>{"CAFÉ", "Café"}));
+  assert((t.suggest("zu") == std::vector<std::string>{"Zürich"}));
+  assert((t.suggest("ZÜ") == std::vector<std::string>{"Zürich"}));
+  assert(t.suggest("x").empty());
+
+  // "cafe" was inserted twice and wins among the spellings.
+  assert((t.suggest_top("ca", 2) == std::vector<std::string>{"cafe", "CAFÉ"}));
+  t.insert("Cafeteria", 10);
+  assert((t.suggest_top("", 1) == std::vector<std::string>{"Cafeteria"}));
+
+  // Zero-weight spellings are still words for suggest_top().
+  trie::FoldedTrie zero;
+  zero.insert("Zéro", 0);
+  assert((zero.suggest_top("ZE", 0) == std::vector<std::string>{"Zéro"}));
+
+  trie::QueryContext ctx;
+  std::vector<std::string> seen;
+  [[maybe_unused]] const std::size_t n = t.suggest("c", 0, ctx, [&seen](std::string_view w)
+                                                   {
+                                                     seen.emplace_back(w);
+                                                     return seen.size() < 3; });
+  assert(n == 3 && seen == t.suggest("c", 3));
+
+  const trie::TrieStats s = t.stats();
+  assert(s.terminals == 3);
+  assert(s.payload_bytes >= std::string_view("CAFÉCafécafeCafeteriaZürich").size());
+}
+
+static void test_against_brute_force()
+{
+  const std::vector<std::string> pieces = {"a", "A", "á", "Á", "e", "é", "È", "ß", "ss", "S", "æ", "b", "日"};
+  std::mt19937 rng(5);
+  std::uniform_int_distribution<std::size_t> pick(0, pieces.size() - 1);
+  std::uniform_int_distribution<int> len(1, 5);
+  std::uniform_int_distribution<int> weight(1, 9);
+
+  trie::FoldedTrie t;
+  // folded key -> spelling -> frequency
+  std::map<std::string, std::map<std::string, std::uint64_t>> ref;
+  for (int i = 0; i < 2000; ++i)
+  {
+    std::string w;
+    for (int k = len(rng); k > 0; --k)
+    {
+      w += pieces[pick(rng)];
+    }
+    const auto f = static_cast<std::uint64_t>(weight(rng));
+    t.insert(w, f);
+    ref[trie::fold(w)][w] += f;
+  }
+
+  for (const std::string prefix : {"", "a", "Á", "ss", "ß", "ae", "Æ", "e", "日", "bz"})
+  {
+    const std::string folded = trie::fold(prefix);
+    std::vector<std::string> expected;
+    std::vector<std::pair<std::uint64_t, std::pair<std::string, std::string>>> ranked;
+    for (const auto &[key, spellings] : ref)
+    {
+      if (key.compare(0, folded.size(), folded) != 0)
+      {
+        continue;
+      }
+      for (const auto &[word, f] : spellings)
+      {
+        expected.push_back(word);
+        ranked.push_back({f, {key, word}});
+      }
+    }
+    assert(t.suggest(prefix) == expected);
+
+    std::sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b)
+              { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+    std::vector<std::string> top;
+    for (std::size_t i = 0; i < ranked.size() && i < 7; ++i)
+    {
+      top.push_back(ranked[i].second.second);
+    }
+    assert(t.suggest_top(prefix, 7) == top);
+  }
+}
+
+int main()
+{
+  test_fold();
+  test_spellings_share_a_key();
+  test_against_brute_force();
+  return 0;
+}
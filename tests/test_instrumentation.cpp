@@ -0,0 +1,171 @@
+#include <trie/instrumentation.hpp>
+#include <trie/radix_trie.hpp>
+#include <trie/sharded_trie.hpp>
+#include <trie/trie.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static_assert(trie::instrumentation_enabled, "this test is built with TRIE_ENABLE_INSTRUMENTATION=1");
+
+namespace
+{
+  class RecordingSink final : public trie::InstrumentationSink
+  {
+  public:
+    void record(trie::Operation op, const trie::OperationCounters &sample) noexcept override
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      samples.emplace_back(op, sample);
+    }
+
+    std::vector<std::pair<trie::Operation, trie::OperationCounters>> take()
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      return std::exchange(samples, {});
+    }
+
+    std::mutex mtx;
+    std::vector<std::pair<trie::Operation, trie::OperationCounters>> samples;
+  };
+
+  const std::vector<std::string> words = {"hello", "help", "helmet", "world", "word", "work"};
+} // namespace
+
+static void test_work_counters()
+{
+  trie::Trie t;
+  for (const std::string &w : words)
+  {
+    t.insert(w);
+  }
+
+  trie::reset_thread_counters();
+  assert(t.contains("hello") && !t.contains("hex"));
+  [[maybe_unused]] const trie::OperationCounters lookups = trie::thread_counters(trie::Operation::contains);
+  assert(lookups.calls == 2);
+  assert(lookups.nodes_visited == 5 + 3);
+  assert(lookups.dp_cells == 0 && lookups.candidates_scored == 0);
+
+  // "hel" + the three completions below it, one node per byte.
+  assert(t.suggest("hel").size() == 3);
+  [[maybe_unused]] const trie::OperationCounters suggest = trie::thread_counters(trie::Operation::suggest);
+  assert(suggest.calls == 1);
+  assert(suggest.nodes_visited == 3 + 1 + 2 + 1 + 3);
+
+  const std::string_view query = "helo";
+  std::size_t cells = 0;
+  for (const std::string &w : words)
+  {
+    cells += query.size() * w.size();
+  }
+  t.search_ranked(query, 2);
+  [[maybe_unused]] const trie::OperationCounters ranked = trie::thread_counters(trie::Operation::search_ranked);
+  assert(ranked.calls == 1);
+  assert(ranked.candidates_scored == words.size());
+  assert(ranked.dp_cells == cells);
+
+  t.search_fuzzy(query, 1, 10);
+  [[maybe_unused]] const trie::OperationCounters fuzzy = trie::thread_counters(trie::Operation::search_fuzzy);
+  assert(fuzzy.calls == 1 && fuzzy.dp_cells > 0 && fuzzy.dp_cells % query.size() == 0);
+  assert(fuzzy.candidates_scored == 2); // hello, help
+
+  trie::reset_thread_counters();
+  assert(trie::thread_counters(trie::Operation::search_fuzzy).calls == 0);
+}
+
+static void test_sink_gets_one_sample_per_call()
+{
+  RecordingSink sink;
+  trie::set_instrumentation_sink(&sink);
+
+  trie::Trie t(trie::Concurrency::shared);
+  for (const std::string &w : words)
+  {
+    t.insert(w);
+  }
+  t.erase("work");
+  t.suggest("wor");
+  t.suggest_top("he", 2);
+
+  const auto samples = sink.take();
+  assert(samples.size() == words.size() + 3);
+  for (std::size_t i = 0; i < words.size(); ++i)
+  {
+    assert(samples[i].first == trie::Operation::insert);
+    assert(samples[i].second.calls == 1);
+  }
+  assert(samples[words.size()].first == trie::Operation::erase);
+  assert(samples[words.size() + 1].first == trie::Operation::suggest);
+  assert(samples[words.size() + 2].first == trie::Operation::suggest_top);
+  assert(samples[words.size() + 2].second.nodes_visited > 0);
+
+  // A fan-out query reports once, with the work of every shard.
+  trie::ShardedTrie sharded(4, trie::Concurrency::shared, trie::Partition::hash);
+  for (const std::string &w : words)
+  {
+    sharded.insert(w);
+  }
+  sink.take();
+  sharded.search_ranked("helo", 3);
+  const auto fan_out = sink.take();
+  assert(fan_out.size() == 1 && fan_out[0].first == trie::Operation::search_ranked);
+  assert(fan_out[0].second.candidates_scored == words.size());
+
+  trie::RadixTrie radix(true);
+  radix.insert("hello");
+  assert(radix.contains("hello"));
+  const auto radix_samples = sink.take();
+  assert(radix_samples.size() == 2 && radix_samples[1].first == trie::Operation::contains);
+
+  trie::set_instrumentation_sink(nullptr);
+  t.insert("unreported");
+  assert(sink.take().empty());
+}
+
+static void test_lock_wait()
+{
+  trie::Trie t(trie::Concurrency::shared);
+  for (const std::string &w : words)
+  {
+    t.insert(w);
+  }
+
+  // A reader parks inside its visitor, so the writer has to wait for the lock.
+  std::atomic<bool> reading{false};
+  std::thread reader([&]
+                     { t.suggest("", 1, [&](std::string_view)
+                                 {
+                                   reading = true;
+                                   std::this_thread::sleep_for(std::chrono::milliseconds(30)); }); });
+  while (!reading)
+  {
+    std::this_thread::yield();
+  }
+
+  trie::reset_thread_counters();
+  t.insert("late");
+  reader.join();
+
+  [[maybe_unused]] const trie::OperationCounters insert = trie::thread_counters(trie::Operation::insert);
+  assert(insert.calls == 1);
+  assert(insert.lock_wait_ns >= 5'000'000);
+  assert(insert.latency_ns >= insert.lock_wait_ns);
+}
+
+int main()
+{
+  test_work_counters();
+  test_sink_gets_one_sample_per_call();
+  test_lock_wait();
+  return 0;
+}
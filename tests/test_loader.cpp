@@ -0,0 +1,294 @@
+#include <trie/trie.hpp>
+#include <trie/trie_loader.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+static std::vector<std::pair<std::string, trie::Frequency>> sample_counts(unsigned seed, std::size_t n)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> len(1, 8);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::vector<std::pair<std::string, trie::Frequency>> out;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    std::string w;
+    const int k = len(rng);
+    for (int j = 0; j < k; ++j)
+    {
+      const int b = byte(rng);
+      // Keep tabs, newlines and '\r' out of the words.
+      w.push_back(static_cast<char>(b % 5 == 0 && b > 13 ? b : 'a' + b % 6));
+    }
+    out.emplace_back(w, static_cast<trie::Frequency>(byte(rng) % 7));
+  }
+  return out;
+}
+
+static std::string word_list(const std::vector<std::pair<std::string, trie::Frequency>> &counts)
+{
+  std::string text;
+  for (const auto &[w, c] : counts)
+  {
+    text += w;
+    if (c != 1)
+    {
+      text += '\t' + std::to_string(c);
+    }
+    text += (c % 2 == 0) ? "\r\n" : "\n";
+  }
+  return text;
+}
+
+static void check_same([[maybe_unused]] const trie::Trie &ref, [[maybe_unused]] const trie::Trie &t)
+{
+  for ([[maybe_unused]] const char *prefix : {"", "a", "ab", "f", "zz"})
+  {
+    assert(t.suggest(prefix) == ref.suggest(prefix));
+    assert(t.suggest_top(prefix, 7) == ref.suggest_top(prefix, 7));
+  }
+  for ([[maybe_unused]] const char *query : {"abc", "fa", ""})
+  {
+    assert(t.search_ranked(query, 10) == ref.search_ranked(query, 10));
+  }
+  assert(t.stats().nodes == ref.stats().nodes);
+}
+
+static void test_load_matches_inserts()
+{
+  auto counts = sample_counts(3, 3000);
+  counts.emplace_back("", 4);
+  counts.emplace_back("with space", 1);
+
+  trie::Trie ref;
+  for (const auto &[w, c] : counts)
+  {
+    ref.insert(w, c);
+  }
+
+  // "\t4" is the empty word; blank lines are skipped.
+  std::string text = word_list(counts);
+  text += "\n\n";
+
+  for (std::size_t workers : {1u, 4u})
+  {
+    for (std::size_t chunk : {1u, 100u, 100000u})
+    {
+      trie::LoadOptions options;
+      options.workers = workers;
+      options.chunk_lines = chunk;
+      std::istringstream in(text);
+      const std::shared_ptr<trie::Trie> t = trie::TrieLoader(options).load(in);
+      check_same(ref, *t);
+      assert(t->frequency("") == 4 && t->frequency("with space") == 1);
+    }
+  }
+
+  trie::LoadOptions frozen;
+  frozen.workers = 3;
+  frozen.freeze = true;
+  std::istringstream in("b\t2\na\nb\nab\t5\n");
+  const auto t = trie::TrieLoader(frozen).load(in);
+  assert(t->frozen());
+  assert(t->frequency("b") == 3 && t->frequency("ab") == 5);
+  assert((t->suggest_top("", 2) == std::vector<std::string>{"ab", "b"}));
+}
+
+/**
+ * @brief Non-synchronized pool that records calls overlapping another call.
+ */
+class UnsynchronizedResource final : public std::pmr::memory_resource
+{
+public:
+  std::atomic<std::size_t> overlapping_calls{0};
+
+private:
+  void *do_allocate(std::size_t bytes, std::size_t align) override
+  {
+    enter();
+    void *p = pool_.allocate(bytes, align);
+    active_.fetch_sub(1);
+    return p;
+  }
+
+  void do_deallocate(void *p, std::size_t bytes, std::size_t align) override
+  {
+    enter();
+    pool_.deallocate(p, bytes, align);
+    active_.fetch_sub(1);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+  void enter()
+  {
+    if (active_.fetch_add(1) != 0)
+    {
+      overlapping_calls.fetch_add(1);
+    }
+    std::this_thread::yield();
+  }
+
+  std::atomic<int> active_{0};
+  std::pmr::unsynchronized_pool_resource pool_;
+};
+
+static void test_parallel_load_serializes_resource()
+{
+  const auto counts = sample_counts(9, 5000);
+  trie::Trie ref;
+  for (const auto &[w, c] : counts)
+  {
+    ref.insert(w, c);
+  }
+
+  UnsynchronizedResource resource;
+  {
+    trie::LoadOptions options;
+    options.workers = 4;
+    options.chunk_lines = 512;
+    options.resource = &resource;
+    std::istringstream in(word_list(counts));
+    const std::shared_ptr<trie::Trie> t = trie::TrieLoader(options).load(in);
+    check_same(ref, *t);
+  }
+  assert(resource.overlapping_calls.load() == 0);
+}
+
+static void test_load_errors()
+{
+  for (const char *bad : {"a\t\n", "a\tx\n", "a\t12x\n", "a\t-1\n"})
+  {
+    std::istringstream in(std::string("ok\n") + bad);
+    [[maybe_unused]] bool threw = false;
+    try
+    {
+      trie::TrieLoader().load(in);
+    }
+    catch (const std::invalid_argument &e)
+    {
+      threw = std::string(e.what()).find("line 2") != std::string::npos;
+    }
+    assert(threw);
+  }
+
+  [[maybe_unused]] bool threw = false;
+  try
+  {
+    trie::TrieLoader().load(std::string("trie_loader_test_missing.txt"));
+  }
+  catch (const std::system_error &)
+  {
+    threw = true;
+  }
+  assert(threw);
+}
+
+static void test_handle_reload()
+{
+  const std::string path = "trie_loader_test.txt";
+  {
+    std::ofstream out(path, std::ios::binary);
+    for (int i = 0; i < 20000; ++i)
+    {
+      out << "new" << i << "\t" << (i % 10 + 1) << "\n";
+    }
+  }
+
+  auto initial = std::make_shared<trie::Trie>();
+  for (int i = 0; i < 100; ++i)
+  {
+    initial->insert("old" + std::to_string(i));
+  }
+  trie::TrieHandle handle(initial);
+  initial.reset();
+  assert(handle.version() == 0 && handle.get()->contains("old7"));
+
+  // Readers see one complete dictionary or the other, never a mix.
+  std::atomic<bool> done{false};
+  std::atomic<int> failures{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r)
+  {
+    readers.emplace_back([&]
+                         {
+      while (!done.load())
+      {
+        const std::shared_ptr<const trie::Trie> t = handle.get();
+        const bool old_words = t->contains("old42") && t->suggest("old", 0).size() == 100;
+        const bool new_words = t->contains("new19999") && t->suggest("new1999", 0).size() == 11;
+        if (old_words == new_words)
+          failures.fetch_add(1);
+      } });
+  }
+
+  trie::LoadOptions options;
+  options.workers = 2;
+  options.chunk_lines = 1000;
+  handle.reload(path, options);
+  handle.wait();
+  done.store(true);
+  for (std::thread &th : readers)
+  {
+    th.join();
+  }
+  assert(failures.load() == 0);
+  assert(handle.version() == 1);
+  assert(!handle.get()->contains("old1") && handle.get()->frequency("new15") == 6);
+
+  // A reference held across the swap does not hold up wait() or the next reload.
+  {
+    const std::shared_ptr<const trie::Trie> held = handle.get();
+    handle.reload([]
+                  { auto t = std::make_shared<trie::Trie>();
+                    t->insert("next");
+                    return t; });
+    handle.wait();
+    assert(held->contains("new0") && handle.get()->contains("next") && handle.version() == 2);
+    handle.reload(path, options);
+    handle.wait();
+    assert(held->contains("new0") && handle.version() == 3);
+  }
+
+  // A failed build keeps the current trie and reports through wait().
+  handle.reload([]() -> std::shared_ptr<trie::Trie>
+                { throw std::runtime_error("build failed"); });
+  [[maybe_unused]] bool threw = false;
+  try
+  {
+    handle.wait();
+  }
+  catch (const std::runtime_error &)
+  {
+    threw = true;
+  }
+  assert(threw && handle.version() == 3 && handle.get()->contains("new0"));
+  handle.wait();
+
+  // store() publishes directly and hands back the previous trie.
+  const std::shared_ptr<const trie::Trie> previous = handle.store(std::make_shared<const trie::Trie>());
+  assert(previous->contains("new0") && !handle.get()->contains("new0") && handle.version() == 4);
+
+  std::remove(path.c_str());
+}
+
+int main()
+{
+  test_load_matches_inserts();
+  test_parallel_load_serializes_resource();
+  test_load_errors();
+  test_handle_reload();
+  return 0;
+}
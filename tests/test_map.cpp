@@ -0,0 +1,211 @@
+#include <trie/trie_map.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+static void test_find_and_assign()
+{
+  trie::TrieMap<std::string> m;
+  assert(m.empty() && m.find("a") == nullptr);
+
+  [[maybe_unused]] auto [v, inserted] = m.insert_or_assign("apple", "red");
+  assert(inserted && v == "red");
+  assert(!m.insert_or_assign("apple", std::string("green")).second);
+  assert(*m.find("apple") == "green");
+
+  assert(!m.try_emplace("apple", "yellow").second);
+  assert(*m.find("apple") == "green");
+  assert(m.try_emplace("app", 3, 'x').second && *m.find("app") == "xxx");
+
+  m[""] = "empty";
+  m["apply"] += "verb";
+  assert(m.size() == 4);
+  assert(*m.find("") == "empty" && *m.find("apply") == "verb");
+  assert(m.find("ap") == nullptr && m.find("apples") == nullptr);
+  assert(m.contains("app") && !m.contains("a"));
+
+  // References stay valid while other keys come and go.
+  [[maybe_unused]] std::string &apple = *m.find("apple");
+  for (int i = 0; i < 1000; ++i)
+  {
+    m[std::to_string(i)] = "n";
+  }
+  assert(m.erase("0") && !m.erase("0"));
+  assert(&apple == m.find("apple") && apple == "green");
+
+  // Move-only values.
+  trie::TrieMap<std::unique_ptr<int>> owners;
+  owners.insert_or_assign("k", std::make_unique<int>(7));
+  owners.insert_or_assign("k", std::make_unique<int>(8));
+  assert(**owners.find("k") == 8);
+}
+
+static void test_erase_prunes_and_reuses()
+{
+  trie::TrieMap<std::vector<int>> m;
+  m["car"] = {1};
+  m["cart"] = {2, 3};
+  m["care"] = {4};
+  [[maybe_unused]] const std::size_t nodes = m.stats().nodes;
+
+  assert(!m.erase("ca") && !m.erase("cars"));
+  assert(m.erase("cart") && m.size() == 2);
+  assert(m.stats().nodes == nodes - 1);
+  assert(m.erase("car") && m.stats().nodes == nodes - 1);
+  assert(m.erase("care") && m.empty() && m.stats().nodes == 1);
+
+  // Freed slots are reused instead of growing the value storage.
+  [[maybe_unused]] const std::size_t payload = m.stats().payload_bytes;
+  m["dog"] = {5};
+  m["dot"] = {6};
+  assert(m.stats().payload_bytes == payload);
+  assert(*m.find("dog") == std::vector<int>{5});
+  assert(m.find("cart") == nullptr);
+}
+
+static void test_for_each_prefix()
+{
+  trie::TrieMap<int> m;
+  for (const auto &[k, v] : std::vector<std::pair<std::string, int>>{
+           {"to", 1}, {"tea", 2}, {"ted", 3}, {"ten", 4}, {"i", 5}, {"in", 6}, {"inn", 7}, {"t\xff", 8}})
+  {
+    m.insert_or_assign(k, v);
+  }
+
+  std::vector<std::pair<std::string, int>> seen;
+  [[maybe_unused]] const std::size_t n = m.for_each_prefix("te", [&seen](std::string_view key, int &value)
+                                                           {
+                                                             seen.emplace_back(key, value);
+                                                             value *= 10; });
+  assert(n == 3);
+  assert((seen == std::vector<std::pair<std::string, int>>{{"tea", 2}, {"ted", 3}, {"ten", 4}}));
+  assert(*m.find("ted") == 30);
+
+  // Byte order, unsigned; the prefix itself when it is a key.
+  seen.clear();
+  const trie::TrieMap<int> &cm = m;
+  cm.for_each_prefix("t", [&seen](std::string_view key, const int &value)
+                     { seen.emplace_back(key, value); });
+  assert((seen == std::vector<std::pair<std::string, int>>{{"tea", 20}, {"ted", 30}, {"ten", 40}, {"to", 1}, {"t\xff", 8}}));
+
+  trie::QueryContext ctx;
+  std::vector<std::string> keys;
+  [[maybe_unused]] const std::size_t stopped = m.for_each_prefix("", ctx, [&keys](std::string_view key, int &)
+                                                                 {
+                                                                   keys.emplace_back(key);
+                                                                   return keys.size() < 3; });
+  assert(stopped == 3 && (keys == std::vector<std::string>{"i", "in", "inn"}));
+  assert(m.for_each_prefix("x", ctx, [](std::string_view, int &) {}) == 0);
+}
+
+static void test_against_std_map()
+{
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int> letter('a', 'd');
+  std::uniform_int_distribution<int> len(0, 6);
+  std::uniform_int_distribution<int> op(0, 9);
+
+  trie::TrieMap<std::string> m;
+  std::map<std::string, std::string> ref;
+  for (int i = 0; i < 20000; ++i)
+  {
+    std::string k;
+    for (int n = len(rng); n > 0; --n)
+    {
+      k.push_back(static_cast<char>(letter(rng)));
+    }
+
+    const int o = op(rng);
+    if (o < 3)
+    {
+      assert(m.erase(k) == (ref.erase(k) == 1));
+    }
+    else if (o < 7)
+    {
+      const std::string v = std::to_string(i);
+      assert(m.insert_or_assign(k, v).second == ref.insert_or_assign(k, v).second);
+    }
+    else
+    {
+      [[maybe_unused]] const std::string *v = m.find(k);
+      [[maybe_unused]] const auto it = ref.find(k);
+      assert((v == nullptr) == (it == ref.end()));
+      assert(!v || *v == it->second);
+    }
+  }
+  assert(m.size() == ref.size());
+
+  for (const std::string prefix : {"", "a", "cb", "dddd", "abcdab"})
+  {
+    std::vector<std::pair<std::string, std::string>> expected;
+    for (auto it = ref.lower_bound(prefix); it != ref.end() && it->first.starts_with(prefix); ++it)
+    {
+      expected.emplace_back(*it);
+    }
+    std::vector<std::pair<std::string, std::string>> got;
+    m.for_each_prefix(prefix, [&got](std::string_view key, std::string &value)
+                      { got.emplace_back(key, value); });
+    assert(got == expected);
+  }
+
+  const trie::TrieStats s = m.stats();
+  assert(s.terminals == ref.size());
+}
+
+/**
+ * @brief Value whose constructor throws on request.
+ */
+struct Fragile final
+{
+  explicit Fragile(bool fail)
+  {
+    if (fail)
+    {
+      throw std::runtime_error("fragile");
+    }
+  }
+};
+
+static void test_try_emplace_rolls_back()
+{
+  trie::TrieMap<Fragile> m;
+  m.try_emplace("ab", false);
+  const trie::TrieStats before = m.stats();
+
+  // New branch below an existing key, a branch from the root, and a node that already exists.
+  for (const char *key : {"abcd", "xyz", "a"})
+  {
+    [[maybe_unused]] bool threw = false;
+    try
+    {
+      m.try_emplace(key, true);
+    }
+    catch (const std::runtime_error &)
+    {
+      threw = true;
+    }
+    assert(threw && !m.contains(key) && m.size() == 1);
+    assert(m.stats().nodes == before.nodes && m.stats().payload_bytes == before.payload_bytes);
+  }
+
+  [[maybe_unused]] const bool inserted = m.try_emplace("abcd", false).second;
+  assert(inserted && m.contains("abcd") && m.stats().nodes == before.nodes + 2);
+}
+
+int main()
+{
+  test_find_and_assign();
+  test_erase_prunes_and_reuses();
+  test_for_each_prefix();
+  test_against_std_map();
+  test_try_emplace_rolls_back();
+  return 0;
+}
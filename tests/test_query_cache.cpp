@@ -0,0 +1,114 @@
+#include <trie/query_cache.hpp>
+#include <trie/sharded_trie.hpp>
+#include <trie/trie.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static void test_hits_and_invalidation()
+{
+  trie::Trie t;
+  t.insert("apple");
+  t.insert("apply");
+  t.insert("banana");
+
+  trie::QueryCache cache(t, 64, 4);
+  assert(cache.suggest("app") == t.suggest("app"));
+  assert(cache.suggest("app") == t.suggest("app"));
+  assert(cache.hits() == 1 && cache.misses() == 1);
+
+  // Limit and query kind are part of the key.
+  assert(cache.suggest("app", 1) == t.suggest("app", 1));
+  assert(cache.search_ranked("app", 10) == t.search_ranked("app", 10));
+  assert(cache.search_fuzzy("app", 2, 10) == t.search_fuzzy("app", 2, 10));
+  assert(cache.search_fuzzy("app", 1, 10) == t.search_fuzzy("app", 1, 10));
+  assert(cache.misses() == 5 && cache.size() == 5);
+
+  t.insert("appetite");
+  assert(cache.suggest("app") == t.suggest("app"));
+  assert(cache.misses() == 6);
+
+  assert(t.erase("apple"));
+  assert(cache.search_ranked("app", 10) == t.search_ranked("app", 10));
+  assert(cache.misses() == 7);
+
+  cache.clear();
+  assert(cache.size() == 0);
+}
+
+static void test_capacity_bound()
+{
+  trie::Trie t;
+  for (int i = 0; i < 100; ++i)
+  {
+    t.insert("w" + std::to_string(i));
+  }
+
+  trie::QueryCache cache(t, 8, 2);
+  for (int i = 0; i < 100; ++i)
+  {
+    assert(cache.suggest("w" + std::to_string(i)) == t.suggest("w" + std::to_string(i)));
+    assert(cache.size() <= 8);
+  }
+
+  // The most recently used entry survives eviction of older ones.
+  cache.suggest("w99");
+  assert(cache.hits() == 1);
+
+  // Capacities that do not divide by the shard count, or are below it, still bound the total.
+  for (const auto &[capacity, shards] : std::vector<std::pair<std::size_t, std::size_t>>{{10, 4}, {3, 16}, {1, 4}, {0, 4}})
+  {
+    trie::QueryCache small(t, capacity, shards);
+    for (int i = 0; i < 100; ++i)
+    {
+      small.suggest("w" + std::to_string(i));
+      assert(small.size() <= capacity);
+    }
+    assert(small.size() == capacity);
+  }
+}
+
+static void test_concurrent_readers_and_writer()
+{
+  trie::ShardedTrie t(4, trie::Concurrency::shared);
+  for (int i = 0; i < 200; ++i)
+  {
+    t.insert("base" + std::to_string(i));
+  }
+
+  trie::QueryCache cache(t, 256);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; ++r)
+  {
+    readers.emplace_back([&cache]
+                         {
+      for (int i = 0; i < 2000; ++i)
+      {
+        assert(cache.suggest("base1", 5).size() == 5);
+        cache.search_ranked("base" + std::to_string(i % 7), 3);
+      } });
+  }
+  for (int i = 0; i < 500; ++i)
+  {
+    t.insert("new" + std::to_string(i));
+  }
+  for (std::thread &r : readers)
+  {
+    r.join();
+  }
+
+  assert(cache.suggest("new", 0) == t.suggest("new", 0));
+  assert(cache.suggest("new", 0).size() == 500);
+}
+
+int main()
+{
+  test_hits_and_invalidation();
+  test_capacity_bound();
+  test_concurrent_readers_and_writer();
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include <trie/radix_trie.hpp>
+#include <trie/trie.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+static std::vector<std::string> sample_words()
+{
+  std::vector<std::string> words = {
+      "https://example.com/products/sku-000123",
+      "https://example.com/products/sku-000124",
+      "https://example.com/products/sku-0001",
+      "https://example.com/about",
+      "https://example.org/",
+      "romane",
+      "romanus",
+      "romulus",
+      "rubens",
+      "ruber",
+      "rubicon",
+      "rubicundus",
+      "r",
+      "",
+  };
+
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> len(1, 12);
+  std::uniform_int_distribution<int> letter('a', 'e');
+  for (int i = 0; i < 500; ++i)
+  {
+    std::string w;
+    const int n = len(rng);
+    for (int j = 0; j < n; ++j)
+    {
+      w.push_back(static_cast<char>(letter(rng)));
+    }
+    words.push_back(w);
+  }
+  return words;
+}
+
+static void test_insert_and_contains()
+{
+  trie::RadixTrie t;
+
+  t.insert("romane");
+  t.insert("romanus");
+  t.insert("rom");
+
+  assert(t.contains("romane"));
+  assert(t.contains("romanus"));
+  assert(t.contains("rom"));
+
+  assert(!t.contains("roman"));
+  assert(!t.contains("ro"));
+  assert(!t.contains("romanes"));
+  assert(!t.contains(""));
+}
+
+static void test_prefix_inside_edge()
+{
+  trie::RadixTrie t;
+
+  t.insert("https://example.com/a");
+  t.insert("https://example.com/b");
+
+  const auto s = t.suggest("https://ex");
+  assert((s == std::vector<std::string>{"https://example.com/a", "https://example.com/b"}));
+  assert(t.suggest("https://x").empty());
+  assert(t.suggest("https://example.com/a/").empty());
+}
+
+static void test_matches_trie()
+{
+  trie::Trie ref;
+  trie::RadixTrie t;
+
+  for (const auto &w : sample_words())
+  {
+    ref.insert(w);
+    t.insert(w);
+  }
+
+  for (const auto &w : sample_words())
+  {
+    assert(t.contains(w));
+    assert(t.contains(w + "!") == ref.contains(w + "!"));
+    if (!w.empty())
+    {
+      assert(t.contains(w.substr(0, w.size() - 1)) == ref.contains(w.substr(0, w.size() - 1)));
+    }
+  }
+
+  for ([[maybe_unused]] const char *prefix : {"", "a", "ab", "https://example.com/p", "rub", "zz"})
+  {
+    assert(t.suggest(prefix) == ref.suggest(prefix));
+    assert(t.suggest(prefix, 3) == ref.suggest(prefix, 3));
+  }
+
+  for ([[maybe_unused]] const char *query : {"abc", "rubicon", "https://example.com/products/sku-000125"})
+  {
+    assert(t.search_ranked(query, 10) == ref.search_ranked(query, 10));
+    assert(t.search_fuzzy(query, 2, 0) == ref.search_fuzzy(query, 2, 0));
+    assert(t.search_fuzzy(query, std::numeric_limits<std::size_t>::max(), 0) == ref.search_ranked(query, 0));
+  }
+}
+
+static void test_weights_match_trie()
+{
+  trie::Trie ref;
+  trie::RadixTrie t;
+
+  // Past 32 bits, and saturating at the top: engines rank the same counts alike.
+  const std::uint64_t top = std::numeric_limits<std::uint64_t>::max();
+  for (const auto &[w, f] : std::vector<std::pair<std::string, std::uint64_t>>{
+           {"alpha", (std::uint64_t{1} << 32) + 1}, {"alpine", 7}, {"alps", top}, {"alps", 9}, {"also", 0}})
+  {
+    ref.insert(w, f);
+    t.insert(w, f);
+  }
+
+  for ([[maybe_unused]] const char *query : {"alp", "also", "al"})
+  {
+    assert(t.search_ranked(query, 0) == ref.search_ranked(query, 0));
+  }
+  assert(t.search_ranked("alpine", 1) == std::vector<std::string>{"alps"});
+}
+
+static void test_stats()
+{
+  trie::RadixTrie t;
+  std::size_t label_bytes = 0;
+  for (const auto &w : {"romane", "romanus", "romulus", "rubens"})
+  {
+    t.insert(w);
+  }
+  // r -> (om -> (an -> (e, us), ulus), ubens)
+  for (const char *edge : {"r", "om", "an", "e", "us", "ulus", "ubens"})
+  {
+    label_bytes += std::char_traits<char>::length(edge);
+  }
+
+  const trie::TrieStats s = t.stats();
+  assert(s.nodes == 8);
+  assert(s.terminals == 4);
+  assert(s.payload_bytes == label_bytes);
+  assert(s.node_bytes == 8 * sizeof(trie::RadixNode));
+  assert((s.fanout == std::vector<std::size_t>{4, 1, 3}));
+  assert((s.depth == std::vector<std::size_t>{1, 1, 2, 2, 2}));
+  assert(s.used_bytes() <= s.reserved_bytes);
+}
+
+int main()
+{
+  test_insert_and_contains();
+  test_prefix_inside_edge();
+  test_matches_trie();
+  test_weights_match_trie();
+  test_stats();
+  return 0;
+}
@@ -0,0 +1,139 @@
+#include <trie/sharded_trie.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static std::vector<std::pair<std::string, std::uint32_t>> sample_words()
+{
+  std::mt19937 rng(11);
+  std::vector<std::pair<std::string, std::uint32_t>> words = {{"", 2}, {"a", 1}, {"\xff\x01", 3}};
+  const std::string alphabet = "abcdeq";
+  for (int i = 0; i < 1500; ++i)
+  {
+    std::string w;
+    const std::size_t n = rng() % 7 + 1;
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      w.push_back(alphabet[rng() % alphabet.size()]);
+    }
+    words.emplace_back(std::move(w), static_cast<std::uint32_t>(rng() % 20 + 1));
+  }
+  return words;
+}
+
+static void test_matches_single_trie()
+{
+  const auto words = sample_words();
+
+  trie::Trie ref;
+  for (const auto &kv : words)
+  {
+    ref.insert(kv.first, kv.second);
+  }
+
+  for (trie::Partition partition : {trie::Partition::first_byte, trie::Partition::hash})
+  {
+    trie::ShardedTrie sharded(5, trie::Concurrency::shared, partition);
+    sharded.merge_counts(std::vector<std::pair<std::string, std::uint32_t>>(words.begin(), words.begin() + 700));
+    for (std::size_t i = 700; i < words.size(); ++i)
+    {
+      sharded.insert(words[i].first, words[i].second);
+    }
+
+    for ([[maybe_unused]] const auto &kv : words)
+    {
+      assert(sharded.contains(kv.first));
+      assert(sharded.frequency(kv.first) == ref.frequency(kv.first));
+    }
+    assert(!sharded.contains("zzz"));
+
+    for ([[maybe_unused]] std::string_view prefix : {"", "a", "ab", "qq", "x"})
+    {
+      assert(sharded.suggest(prefix) == ref.suggest(prefix));
+      assert(sharded.suggest(prefix, 7) == ref.suggest(prefix, 7));
+      assert(sharded.suggest_top(prefix, 9) == ref.suggest_top(prefix, 9));
+      assert(sharded.suggest_after(prefix, "ab", 6) == ref.suggest_after(prefix, "ab", 6));
+    }
+
+    for ([[maybe_unused]] std::string_view query : {"", "abc", "qeqd", "dddddddd"})
+    {
+      assert(sharded.search_ranked(query, 12) == ref.search_ranked(query, 12));
+      assert(sharded.search_ranked(query, 0) == ref.search_ranked(query, 0));
+      assert(sharded.search_fuzzy(query, 2, 12) == ref.search_fuzzy(query, 2, 12));
+    }
+
+    assert(sharded.erase("a") && !sharded.contains("a"));
+    assert(sharded.add_frequency("a", 4) == 4);
+  }
+}
+
+static void test_concurrent_inserts()
+{
+  trie::ShardedTrie sharded(4, trie::Concurrency::shared);
+
+  std::vector<std::thread> writers;
+  for (int w = 0; w < 4; ++w)
+  {
+    writers.emplace_back([&sharded, w]
+                         {
+      const std::string letters = "abcdefgh";
+      for (int i = 0; i < 2000; ++i)
+      {
+        sharded.insert(std::string(1, letters[(i + w) % letters.size()]) + std::to_string(i));
+        if (i % 100 == 0)
+        {
+          sharded.suggest("", 3);
+        }
+      } });
+  }
+  for (std::thread &t : writers)
+  {
+    t.join();
+  }
+
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < sharded.shard_count(); ++i)
+  {
+    total += sharded.shard(i).suggest("").size();
+  }
+  assert(total == 4 * 2000);
+  assert(sharded.frequency("a0") == 1 && sharded.frequency("d0") == 1);
+}
+
+static void test_merge_counts_input()
+{
+  trie::ShardedTrie sharded(3, trie::Concurrency::shared, trie::Partition::hash);
+
+  const std::vector<int> ids{4, 2, 4};
+  sharded.merge_counts(ids | std::views::transform([](int id)
+                                                   { return std::pair<std::string, int>("generated-shard-word-" + std::to_string(id), id); }));
+  assert(sharded.frequency("generated-shard-word-4") == 8 && sharded.frequency("generated-shard-word-2") == 2);
+
+  [[maybe_unused]] bool threw = false;
+  try
+  {
+    sharded.merge_counts(std::vector<std::pair<std::string, int>>{{"ok", 1}, {"neg", -3}});
+  }
+  catch (const std::invalid_argument &)
+  {
+    threw = true;
+  }
+  assert(threw && !sharded.contains("ok") && !sharded.contains("neg"));
+}
+
+int main()
+{
+  test_matches_single_trie();
+  test_merge_counts_input();
+  test_concurrent_inserts();
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include <trie/static_trie.hpp>
+#include <trie/trie.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using Commands = trie::StaticTrie<"get", "set", "setex", "setnx", "getset", "del", "exists", "expire", "get">;
+
+static_assert(Commands::size() == 8);
+static_assert(Commands::contains("get") && Commands::contains("setnx") && Commands::contains("expire"));
+static_assert(!Commands::contains("") && !Commands::contains("ge") && !Commands::contains("gets"));
+// root, get, (get)set, set, (set)ex, (set)nx, del, exists, (ex)pire
+static_assert(Commands::node_count() == 1 + 3 + 3 + 3 + 2 + 2 + 3 + 6 + 4);
+
+constexpr std::size_t count_completions(std::string_view prefix)
+{
+  return Commands::suggest(prefix, 0, [](std::string_view) {});
+}
+static_assert(count_completions("set") == 3);
+static_assert(count_completions("ex") == 2);
+static_assert(count_completions("x") == 0);
+
+static void test_matches_trie()
+{
+  const std::vector<std::string> words = {"get", "set", "setex", "setnx", "getset", "del", "exists", "expire"};
+  trie::Trie ref;
+  for (const std::string &w : words)
+  {
+    ref.insert(w);
+  }
+
+  for ([[maybe_unused]] std::string_view prefix : {"", "g", "get", "gets", "s", "set", "setn", "e", "ex", "exp", "z", "deleted"})
+  {
+    assert(Commands::suggest(prefix) == ref.suggest(prefix));
+    assert(Commands::suggest(prefix, 2) == ref.suggest(prefix, 2));
+  }
+
+  // Stop early from the visitor.
+  std::vector<std::string> seen;
+  [[maybe_unused]] const std::size_t n = Commands::suggest("", 0, [&seen](std::string_view w)
+                                                           {
+                                                             seen.emplace_back(w);
+                                                             return seen.size() < 3; });
+  assert(n == 3 && seen == ref.suggest("", 3));
+}
+
+static void test_edge_cases()
+{
+  using Empty = trie::StaticTrie<>;
+  static_assert(Empty::size() == 0 && Empty::node_count() == 1);
+  assert(!Empty::contains("") && Empty::suggest("").empty());
+
+  // The empty word, bytes above 0x7f and an embedded NUL sort like Trie's keys.
+  using Bytes = trie::StaticTrie<"", "\xff", "a\xff", "a\x01", "a", "b\0c">;
+  static_assert(Bytes::contains("") && Bytes::contains("\xff") && Bytes::contains(std::string_view("b\0c", 3)));
+  static_assert(!Bytes::contains("b"));
+
+  trie::Trie ref;
+  for (std::string_view w : {std::string_view(""), std::string_view("\xff"), std::string_view("a\xff"),
+                             std::string_view("a\x01"), std::string_view("a"), std::string_view("b\0c", 3)})
+  {
+    ref.insert(w);
+  }
+  assert(Bytes::suggest("") == ref.suggest(""));
+  assert(Bytes::suggest("a") == ref.suggest("a"));
+}
+
+int main()
+{
+  test_matches_trie();
+  test_edge_cases();
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include <trie/trie.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static std::size_t g_allocations = 0;
+
+void *operator new(std::size_t n)
+{
+  ++g_allocations;
+  if (void *p = std::malloc(n == 0 ? 1 : n))
+  {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+static void fill(trie::Trie &t)
+{
+  t.insert("apple");
+  t.insert("application");
+  t.insert("applied");
+  t.insert("apply");
+  t.insert("banana");
+  t.insert("bandana");
+}
+
+static void test_string_view_inputs()
+{
+  trie::Trie t;
+
+  const std::string_view word = "alice-and-bob";
+  t.insert(word.substr(0, 5));
+  assert(t.contains(std::string_view("alice")));
+  assert(t.contains("alice"));
+  assert(t.contains(std::string("alice")));
+  assert(!t.contains(word));
+}
+
+static void test_visitor_matches_vector()
+{
+  trie::Trie t;
+  fill(t);
+
+  std::vector<std::string> seen;
+  [[maybe_unused]] const std::size_t n = t.suggest("app", 0, [&](std::string_view w)
+                                                   { seen.emplace_back(w); });
+  assert(n == seen.size());
+  assert(seen == t.suggest("app"));
+
+  seen.clear();
+  t.search_ranked("aple", 3, [&](std::string_view w)
+                  { seen.emplace_back(w); });
+  assert(seen == t.search_ranked("aple", 3));
+
+  seen.clear();
+  t.search_fuzzy("bandanna", 2, 0, [&](std::string_view w)
+                 { seen.emplace_back(w); });
+  assert(seen == t.search_fuzzy("bandanna", 2, 0));
+}
+
+static void test_visitor_can_stop()
+{
+  trie::Trie t;
+  fill(t);
+
+  std::size_t calls = 0;
+  [[maybe_unused]] const std::size_t n = t.suggest("app", 0, [&](std::string_view)
+                                                   { return ++calls < 2; });
+  assert(n == 2);
+  assert(calls == 2);
+}
+
+static void test_reused_context_does_not_allocate()
+{
+  trie::Trie t;
+  fill(t);
+  trie::QueryContext ctx;
+
+  std::size_t total = 0;
+  const auto count = [&](std::string_view w)
+  { total += w.size(); };
+
+  // Warm up the context buffers.
+  t.suggest("ap", 0, ctx, count);
+  t.search_ranked("aply", 0, ctx, count);
+  t.search_fuzzy("aply", 2, 0, ctx, count);
+
+  [[maybe_unused]] const std::size_t before = g_allocations;
+  for (int i = 0; i < 100; ++i)
+  {
+    t.suggest("ap", 0, ctx, count);
+    t.search_ranked("aply", 0, ctx, count);
+    t.search_fuzzy("aply", 2, 0, ctx, count);
+  }
+  assert(g_allocations == before);
+  assert(total > 0);
+}
+
+int main()
+{
+  test_string_view_inputs();
+  test_visitor_matches_vector();
+  test_visitor_can_stop();
+  test_reused_context_does_not_allocate();
+  return 0;
+}